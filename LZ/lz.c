@@ -0,0 +1,244 @@
+/***********************************************************************************************************************
+ *
+ *  lz.c
+ *
+ *  Compressione a blocchi con LZ77, LZ78 o blocchi memorizzati così come sono, scelti per ogni blocco.
+ *
+ ***********************************************************************************************************************
+ *                                              FORMATO DEL FILE COMPRESSO                                             *
+ ***********************************************************************************************************************
+ *
+ * Il file viene diviso in blocchi di lz_block_size byte, ogni blocco viene compresso indipendentemente dagli altri con
+ * uno dei codec di common/lz_codec.h: quello indicato da riga di comando oppure quello scelto da codec_select.
+ * Il file compresso inizia con l'intestazione
+ *
+ *                      +--------+----------+--------------------------+------------------------------+
+ *                      | "LZCF" | versione | grandezza dei blocchi (4)| parametri dei codec          |
+ *                      +--------+----------+--------------------------+------------------------------+
+ *
+ * dove i parametri dei codec sono quelli scritti da write_params di ogni codec, nell'ordine degli identificatori
+ * (LZ77: intestazione di un file LZ77, LZ78: intestazione di un file LZ78). Seguono i blocchi:
+ *
+ *                      +-------+--------------------+--------------------+--------------------------+
+ *                      | codec | byte originali (4) | byte compressi (4) | blocco compresso         |
+ *                      +-------+--------------------+--------------------+--------------------------+
+ *
+ * Gli interi sono scritti in little endian. Un blocco viene memorizzato così com'è (CODEC_STORED) anche quando il
+ * codec scelto non lo riduce, quindi un blocco non occupa mai più di LZ_BLOCK_HEADER_SIZE byte in più dei dati
+ * originali.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "lz.h"
+
+/**************************************************VARIABILI GLOBALI***************************************************/
+
+unsigned int lz_block_size = LZ_BLOCK_SIZE;
+unsigned long long codec_blocks[N_CODECS];
+unsigned long long codec_bytes[N_CODECS];
+
+/***********************************************************************************************************************
+*                                                       FUNZIONI                                                       *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * size_t readBytes(unsigned char *, size_t, FILE *)
+ * void writeBytes(const unsigned char *, size_t, FILE *)
+ *
+ * Lettura e scrittura a blocchi dei file, separate dal resto del codice per poterne misurare il tempo (PHASE_TIMING).
+ */
+static size_t readBytes(unsigned char *bytes, size_t size, FILE *infile){
+    PHASE_PUSH(PHASE_READ);
+    size_t readed = fread(bytes, sizeof(unsigned char), size, infile);
+    PHASE_POP();
+    return readed;
+}
+
+static void writeBytes(const unsigned char *bytes, size_t size, FILE *outfile){
+    PHASE_PUSH(PHASE_WRITE);
+    fwrite(bytes, sizeof(unsigned char), size, outfile);
+    PHASE_POP();
+}
+
+/***********************************************************************************************************************
+ * void putUint32(unsigned char [], unsigned long)
+ * unsigned long getUint32(const unsigned char [])
+ *
+ * Scrittura e lettura degli interi a 32 bit delle intestazioni (little endian, indipendente dalla macchina).
+ */
+static void putUint32(unsigned char bytes[], unsigned long value){
+    for(int i=0; i<4; i++)
+        bytes[i] = (unsigned char) (value >> (8*i));
+}
+
+static unsigned long getUint32(const unsigned char bytes[]){
+    unsigned long value = 0;
+    for(int i=3; i>=0; i--)
+        value = value << 8 | bytes[i];
+    return value;
+}
+
+/***********************************************************************************************************************
+ * void writeHeader(FILE *)
+ * int readHeader(FILE *)
+ *
+ * Scrittura e lettura dell'intestazione del file compresso (vedi l'inizio del file). readHeader imposta
+ * lz_block_size e i parametri dei codec con i valori letti.
+ *
+ * @param file
+ * @return      --> 1 se l'intestazione è valida, 0 se il file è troncato, di un'altra versione o con valori non validi
+ */
+static void writeHeader(FILE *outfile){
+    unsigned char header[LZ_HEADER_SIZE];
+
+    memcpy(header, LZ_MAGIC, 4);
+    header[4] = LZ_VERSION;
+    putUint32(&header[5], lz_block_size);
+    writeBytes(header, LZ_HEADER_SIZE, outfile);
+    for(int i=0; i<N_CODECS; i++){
+        if(codec_by_id(i)->write_params != NULL)
+            codec_by_id(i)->write_params(outfile);
+    }
+}
+
+static int readHeader(FILE *infile){
+    unsigned char header[LZ_HEADER_SIZE];
+    unsigned long size;
+
+    if(readBytes(header, LZ_HEADER_SIZE, infile) != LZ_HEADER_SIZE || memcmp(header, LZ_MAGIC, 4) != 0 ||
+       header[4] != LZ_VERSION)
+        return 0;
+    size = getUint32(&header[5]);
+    if(size == 0 || size > LZ_MAX_BLOCK_SIZE)
+        return 0;
+    lz_block_size = (unsigned int) size;
+    for(int i=0; i<N_CODECS; i++){
+        if(codec_by_id(i)->read_params != NULL && !codec_by_id(i)->read_params(infile))
+            return 0;
+    }
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * void writeBlock(int, const unsigned char *, size_t, size_t, FILE *)
+ *
+ * Scrittura di un blocco compresso con la sua intestazione.
+ *
+ * @param codec         --> identificatore del codec
+ * @param packed        --> blocco compresso
+ * @param raw_size      --> byte originali
+ * @param packed_size   --> byte compressi
+ * @param outfile
+ */
+static void writeBlock(int codec, const unsigned char *packed, size_t raw_size, size_t packed_size, FILE *outfile){
+    unsigned char header[LZ_BLOCK_HEADER_SIZE];
+
+    header[0] = (unsigned char) codec;
+    putUint32(&header[1], (unsigned long) raw_size);
+    putUint32(&header[5], (unsigned long) packed_size);
+    writeBytes(header, LZ_BLOCK_HEADER_SIZE, outfile);
+    writeBytes(packed, packed_size, outfile);
+    codec_blocks[codec]++;
+    codec_bytes[codec] += raw_size;
+}
+
+/***********************************************************************************************************************
+*                                                     COMPRESSIONE                                                     *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * int LZ_compressor(FILE *, FILE *, const LZCodec *)
+ *
+ * Compressione del file infile nel file outfile: il file viene letto un blocco alla volta e ogni blocco viene
+ * compresso con codec o, se codec è NULL, con il codec scelto da codec_select. Il blocco compresso deve essere più
+ * piccolo del blocco originale, altrimenti il blocco viene memorizzato così com'è.
+ *
+ * @param infile
+ * @param outfile
+ * @param codec     --> codec di tutti i blocchi, NULL per la scelta automatica
+ * @return          --> 1 se il file è stato compresso, 0 se la memoria non è sufficiente
+ */
+int LZ_compressor(FILE *infile, FILE *outfile, const LZCodec *codec){
+    unsigned char *raw = malloc(lz_block_size);         //blocco da comprimere
+    unsigned char *packed = malloc(lz_block_size);      //blocco compresso
+    unsigned char *scratch = malloc(2 * AUTO_SAMPLE);   //campione e campione compresso di codec_select
+    const LZCodec *chosen;
+    size_t size, packed_size;
+    int ok = raw != NULL && packed != NULL && scratch != NULL;
+
+    if(ok){
+        writeHeader(outfile);
+        while((size = readBytes(raw, lz_block_size, infile)) > 0){
+            chosen = codec != NULL ? codec : codec_select(raw, size, scratch);
+            packed_size = chosen->id == CODEC_STORED ? 0 : chosen->compress(raw, size, packed, size - 1);
+            if(packed_size == 0)
+                writeBlock(CODEC_STORED, raw, size, size, outfile);
+            else
+                writeBlock(chosen->id, packed, size, packed_size, outfile);
+        }
+    }
+
+    free(raw);
+    free(packed);
+    free(scratch);
+    return ok;
+}
+
+/***********************************************************************************************************************
+*                                                    DECOMPRESSIONE                                                    *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * int LZ_decompressor(FILE *, FILE *)
+ *
+ * Decompressione del file infile nel file outfile: dopo l'intestazione (vedi readHeader) i blocchi vengono letti e
+ * decompressi uno alla volta con il codec indicato nella loro intestazione. L'intestazione di ogni blocco viene
+ * controllata prima di leggere il blocco: codec esistente, al massimo lz_block_size byte originali e al massimo
+ * bound(byte originali) byte compressi.
+ *
+ * @param infile
+ * @param outfile
+ * @return          --> 0 se il file è stato decompresso, 1 se il file compresso non è valido o la memoria non è
+ *                      sufficiente
+ */
+int LZ_decompressor(FILE *infile, FILE *outfile){
+    unsigned char header[LZ_BLOCK_HEADER_SIZE];
+    unsigned char *raw = NULL;                          //blocco decompresso
+    unsigned char *packed = NULL;                       //blocco compresso
+    size_t capacity = 0;                                //byte disponibili in packed
+    size_t readed, raw_size, packed_size;
+    const LZCodec *codec;
+    int error = 1;
+
+    if(!readHeader(infile) || (raw = malloc(lz_block_size)) == NULL)
+        return 1;
+
+    while((readed = readBytes(header, LZ_BLOCK_HEADER_SIZE, infile)) == LZ_BLOCK_HEADER_SIZE){
+        codec = codec_by_id(header[0]);
+        raw_size = getUint32(&header[1]);
+        packed_size = getUint32(&header[5]);
+        if(codec == NULL || raw_size == 0 || raw_size > lz_block_size || packed_size > codec->bound(raw_size))
+            break;
+
+        //packed cresce fino al blocco compresso più grande letto
+        if(packed_size > capacity){
+            unsigned char *bigger = realloc(packed, packed_size);
+            if(bigger == NULL)
+                break;
+            packed = bigger;
+            capacity = packed_size;
+        }
+        if(readBytes(packed, packed_size, infile) != packed_size || codec->decompress(packed, packed_size, raw, raw_size))
+            break;
+        writeBytes(raw, raw_size, outfile);
+        codec_blocks[codec->id]++;
+        codec_bytes[codec->id] += raw_size;
+    }
+    if(readed == 0)
+        error = 0;
+
+    free(raw);
+    free(packed);
+    return error;
+}
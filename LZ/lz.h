@@ -0,0 +1,39 @@
+/***********************************************************************************************************************
+ *
+ *  lz.h
+ *
+ *  Definizioni e funzioni del formato a blocchi con scelta del codec per ogni blocco (vedi lz.c).
+ *  Il programma da riga di comando si trova in main.c.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_H
+#define LZ_H
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <stdio.h>
+#include "../common/lz_timing.h"
+#include "../common/lz_codec.h"
+
+/*******************************************************DEFINE*********************************************************/
+
+#define LZ_MAGIC "LZCF"
+#define LZ_VERSION 1
+#define LZ_HEADER_SIZE 9                //"LZCF", versione, grandezza dei blocchi (seguono i parametri dei codec)
+#define LZ_BLOCK_HEADER_SIZE 9          //codec (1 byte), byte originali (4 byte), byte compressi (4 byte)
+#define LZ_BLOCK_SIZE 1048576           //grandezza dei blocchi di default (1 MB)
+#define LZ_MAX_BLOCK_SIZE 1073741824    //grandezza massima dei blocchi (1 GB)
+
+/**************************************************VARIABILI GLOBALI***************************************************/
+
+extern unsigned int lz_block_size;                  //byte originali per blocco (scritta nell'intestazione)
+extern unsigned long long codec_blocks[N_CODECS];   //blocchi compressi o decompressi con ogni codec
+extern unsigned long long codec_bytes[N_CODECS];    //byte originali dei blocchi di ogni codec
+
+/******************************************************FUNZIONI********************************************************/
+
+int LZ_compressor(FILE *infile, FILE *outfile, const LZCodec *codec);
+int LZ_decompressor(FILE *infile, FILE *outfile);
+
+#endif
@@ -0,0 +1,186 @@
+/***********************************************************************************************************************
+ *
+ *  main.c
+ *
+ *  Programma da riga di comando per la compressione e la decompressione a blocchi con scelta del codec (il formato si
+ *  trova in lz.c, i codec in common/lz_codec.h).
+ *
+ *  ./LZ -c [opzioni] inputfile outputfile      --> compressione
+ *  ./LZ -d inputfile outputfile                --> decompressione
+ *
+ *  Opzioni della compressione (la decompressione le legge dall'intestazione del file compresso):
+ *
+ *  -x auto|stored|lz77|lz78        codec di tutti i blocchi, auto sceglie il codec di ogni blocco (default auto)
+ *  -B megabyte                     grandezza dei blocchi, da 1 a 1024 MB (default 1)
+ *  -m, -p, -s, -b, -e              variante, gestione del dizionario pieno, elementi del dizionario e codifica dei
+ *                                  codici del codec lz78 (come per LZ78_V4/main.c)
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lz.h"
+#include "lz78.h"
+
+static const char *mode_names[] = { "lz78", "lzw", "lzmw", "lzap" };
+static const char *policy_names[] = { "reset", "freeze", "monitor", "lru" };
+static const char *coder_names[] = { "bits", "range" };
+
+/***********************************************************************************************************************
+ * int find_name(const char *[], int, const char *)
+ *
+ * Posizione di name nella lista names di n nomi.
+ *
+ * @return  --> posizione, -1 se il nome non è nella lista
+ */
+static int find_name(const char *names[], int n, const char *name){
+    for(int i=0; i<n; i++){
+        if(!strcmp(names[i], name))
+            return i;
+    }
+    return -1;
+}
+
+/***********************************************************************************************************************
+ * void codec_report(FILE *, FILE *)
+ *
+ * Stampa dei blocchi di ogni codec e della grandezza dei file.
+ */
+static void codec_report(FILE *infile, FILE *outfile){
+    for(int i=0; i<N_CODECS; i++)
+        printf("%-8s %llu blocks, %llu bytes\n", codec_by_id(i)->name, codec_blocks[i], codec_bytes[i]);
+    fseek(infile, 0L, SEEK_END);
+    printf("\nInput file size: %ld\n", ftell(infile));
+    fseek(outfile, 0L, SEEK_END);
+    printf("Output file size: %ld\n", ftell(outfile));
+}
+
+/***********************************************************************************************************************
+ * int close_streams(FILE *, FILE *, FILE *, FILE *)
+ *
+ * Chiusura degli stream della pipeline (i file restano aperti).
+ *
+ * @return  --> 0, 1 se c'è stato un errore di lettura o di scrittura
+ */
+static int close_streams(FILE *in, FILE *infile, FILE *out, FILE *outfile){
+    int error = pipe_close(in, infile) != 0;
+
+    if(pipe_close(out, outfile) != 0)
+        error = 1;
+    if(error)
+        printf("Errore nella lettura o nella scrittura dei file\n");
+    return error;
+}
+
+static void usage(const char *program){
+    printf("Usage: %s -c [-x auto|stored|lz77|lz78] [-B megabytes] [-m lz78|lzw|lzmw|lzap] "
+           "[-p reset|freeze|monitor|lru] [-s entries | -b bits] [-e bits|range] inputfile outputfile\n", program);
+    printf("       %s -d inputfile outputfile\n", program);
+}
+
+/***********************************************************************************************************************
+                                                        MAIN
+***********************************************************************************************************************/
+int main(int argc, char *argv[]){
+    FILE *infile, *outfile;
+    FILE *in, *out;                     //stream della pipeline (vedi common/lz_pipeline.h)
+    const LZCodec *codec = NULL;        //NULL = scelta automatica
+    long size = DICTIONARY_SIZE;
+    long block_mb = LZ_BLOCK_SIZE >> 20;
+    int compress, error = 0;
+
+    if(argc < 4 || (strcmp(argv[1], "-c") && strcmp(argv[1], "-d"))){
+        usage(argv[0]);
+        return 1;
+    }
+    compress = !strcmp(argv[1], "-c");
+
+    //Lettura delle opzioni (solo per la compressione)
+    for(int i=2; i<argc-2; i++){
+        if(!compress || i + 1 >= argc - 2){
+            printf("!WARNING! Wrong option (%s)\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+        if(!strcmp(argv[i], "-x")){
+            codec = codec_by_name(argv[++i]);
+            if(codec == NULL && strcmp(argv[i], "auto")){
+                printf("!WARNING! Wrong value (%s) for option %s\n", argv[i], argv[i - 1]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "-B")){
+            block_mb = atol(argv[++i]);
+        } else if(!strcmp(argv[i], "-m")){
+            codec_mode = find_name(mode_names, 4, argv[++i]);
+        } else if(!strcmp(argv[i], "-p")){
+            codec_policy = find_name(policy_names, 4, argv[++i]);
+        } else if(!strcmp(argv[i], "-s")){
+            size = atol(argv[++i]);
+        } else if(!strcmp(argv[i], "-b")){
+            long bits = atol(argv[++i]);
+            size = bits >= 9 && bits <= 24 ? (1L << bits) - 1 : 0;
+        } else if(!strcmp(argv[i], "-e")){
+            coder = find_name(coder_names, 2, argv[++i]);
+        } else {
+            printf("!WARNING! Wrong option (%s)\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+        if(codec_mode < 0 || codec_policy < 0 || coder < 0 || size < MIN_DICTIONARY_SIZE ||
+           size > MAX_DICTIONARY_SIZE || block_mb < 1 || block_mb > LZ_MAX_BLOCK_SIZE >> 20){
+            printf("!WARNING! Wrong value (%s) for option %s\n", argv[i], argv[i - 1]);
+            return 1;
+        }
+    }
+    if(codec_mode == MODE_LZMW && codec_policy == POLICY_LRU){
+        printf("!WARNING! Policy lru is not available with lzmw\n");
+        return 1;
+    }
+    dictionary_size = (unsigned int) size;
+    lz_block_size = (unsigned int) block_mb << 20;
+
+    infile = fopen(argv[argc - 2], "rb");
+    if(infile == NULL){
+        printf("!WARNING! Input file doesn't exists!\n");
+        return 1;
+    }
+    outfile = fopen(argv[argc - 1], "wb");
+    if(outfile == NULL){
+        printf("!WARNING! Output file can't be created!\n");
+        fclose(infile);
+        return 1;
+    }
+
+    timing_start();
+    in = pipe_open_reader(infile);
+    out = pipe_open_writer(outfile);
+    if(compress){
+        printf("\nCOMPRESSIONE (%s, blocchi di %u MB) -> ", codec != NULL ? codec->name : "auto", lz_block_size >> 20);
+        if(!LZ_compressor(in, out, codec)){
+            printf("Errore nell'allocazione dei blocchi\n");
+            error = 1;
+        }
+        error |= close_streams(in, infile, out, outfile);
+        timing_stop();
+        timing_report(stdout);
+        timing_export("lz", "compress");
+    } else {
+        printf("\nDECOMPRESSIONE -> ");
+        if(LZ_decompressor(in, out)){
+            printf("Errore: file compresso non valido\n");
+            error = 1;
+        }
+        error |= close_streams(in, infile, out, outfile);
+        timing_stop();
+        timing_report(stdout);
+        timing_export("lz", "decompress");
+    }
+    codec_report(infile, outfile);
+
+    fclose(infile);
+    fclose(outfile);
+    return error;
+}
@@ -0,0 +1,442 @@
+/***********************************************************************************************************************
+ *
+ *  batch.c
+ *
+ *  Compressione e decompressione di molti file in un solo processo, su più thread.
+ *
+ ***********************************************************************************************************************
+ *                                                  MODALITÀ BATCH                                                     *
+ ***********************************************************************************************************************
+ *
+ * I file da elaborare sono quelli regolari di una cartella oppure quelli elencati in un file di testo (un percorso
+ * per riga). I file compressi vengono scritti nella cartella di destinazione con il nome del file originale più
+ * BATCH_EXTENSION, i file decompressi con il nome del file compresso senza BATCH_EXTENSION. Due file con lo stesso
+ * nome (da cartelle diverse di una lista) non vengono scritti sullo stesso file: solo il primo viene elaborato.
+ *
+ * I thread lavorano con il work stealing: i file vengono ordinati dal più grande al più piccolo e distribuiti a turno
+ * nelle code dei thread, ogni thread prende i file dall'inizio della sua coda (prima i più grandi). Un thread che ha
+ * finito la sua coda ruba la metà dei file rimasti (i più piccoli) al thread con la coda più lunga, quindi i thread
+ * restano occupati fino alla fine anche se i file hanno grandezze molto diverse.
+ *
+ * Ogni thread usa lo stesso contesto (struct lz77_context, vedi LZ77_newContext) per tutti i suoi file, quindi i
+ * buffer da qualche MB della compressione e della decompressione vengono allocati una volta per thread e non una
+ * volta per file. I file vengono letti e scritti direttamente dai thread (senza la pipeline di common/lz_pipeline.h):
+ * mentre un thread legge o scrive gli altri comprimono.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#define _POSIX_C_SOURCE 200809L     //strdup, mkdir
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "batch.h"
+
+#define LINE_SIZE 4096              //lunghezza massima di una riga della lista dei file
+
+/***********************************************************************************************************************
+*                                                       FUNZIONI                                                       *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * char *outputName(const char *, const char *, int)
+ *
+ * Percorso del file di destinazione: nome del file (senza cartelle) nella cartella outdir, con BATCH_EXTENSION
+ * aggiunta per la compressione o tolta per la decompressione (".out" se il file compresso non ha BATCH_EXTENSION).
+ *
+ * @param input
+ * @param outdir
+ * @param compress
+ * @return          --> percorso allocato, NULL se la memoria non è sufficiente
+ */
+static char *outputName(const char *input, const char *outdir, int compress){
+    const char *name = strrchr(input, '/') != NULL ? strrchr(input, '/') + 1 : input;
+    size_t length = strlen(name);
+    size_t extension = strlen(BATCH_EXTENSION);
+    char *output = malloc(strlen(outdir) + length + extension + 6);
+
+    if(output == NULL)
+        return NULL;
+    if(compress)
+        sprintf(output, "%s/%s%s", outdir, name, BATCH_EXTENSION);
+    else if(length > extension && !strcmp(name + length - extension, BATCH_EXTENSION))
+        sprintf(output, "%s/%.*s", outdir, (int) (length - extension), name);
+    else
+        sprintf(output, "%s/%s.out", outdir, name);
+    return output;
+}
+
+/***********************************************************************************************************************
+ * int addFile(struct batch_run *, int *, const char *, const char *)
+ *
+ * Aggiunta di un file alla lista (solo file regolari, gli altri percorsi vengono ignorati con un avviso se non
+ * esistono).
+ *
+ * @param run
+ * @param capacity  --> elementi allocati in run->files, aggiornato
+ * @param input
+ * @param outdir
+ * @return          --> 1, 0 se la memoria non è sufficiente
+ */
+static int addFile(struct batch_run *run, int *capacity, const char *input, const char *outdir){
+    struct batch_file *file;
+    struct stat st;
+
+    if(stat(input, &st) != 0){
+        printf("!WARNING! %s doesn't exists!\n", input);
+        return 1;
+    }
+    if(!S_ISREG(st.st_mode))
+        return 1;
+    if(run->n_files == *capacity){
+        struct batch_file *bigger = realloc(run->files, (size_t) (*capacity * 2 + 16) * sizeof(struct batch_file));
+        if(bigger == NULL)
+            return 0;
+        run->files = bigger;
+        *capacity = *capacity * 2 + 16;
+    }
+
+    file = &run->files[run->n_files];
+    memset(file, 0, sizeof(struct batch_file));
+    file->input = strdup(input);
+    file->output = outputName(input, outdir, run->compress);
+    file->input_size = (long long) st.st_size;
+    run->n_files++;
+    return file->input != NULL && file->output != NULL;
+}
+
+/***********************************************************************************************************************
+ * int listFiles(struct batch_run *, const char *, const char *)
+ *
+ * Lista dei file da elaborare: i file regolari della cartella source oppure, se source è un file, i percorsi
+ * elencati nel file (uno per riga, le righe vuote vengono ignorate).
+ *
+ * @param run
+ * @param source
+ * @param outdir
+ * @return          --> 1, 0 se source non può essere letto o la memoria non è sufficiente
+ */
+static int listFiles(struct batch_run *run, const char *source, const char *outdir){
+    struct stat st;
+    int capacity = 0;
+    int ok = 1;
+
+    if(stat(source, &st) != 0)
+        return 0;
+
+    if(S_ISDIR(st.st_mode)){
+        DIR *dir = opendir(source);
+        struct dirent *entry;
+        char *path;
+
+        if(dir == NULL)
+            return 0;
+        while(ok && (entry = readdir(dir)) != NULL){
+            if(entry->d_name[0] == '.')
+                continue;
+            if((path = malloc(strlen(source) + strlen(entry->d_name) + 2)) == NULL){
+                ok = 0;
+                break;
+            }
+            sprintf(path, "%s/%s", source, entry->d_name);
+            ok = addFile(run, &capacity, path, outdir);
+            free(path);
+        }
+        closedir(dir);
+    } else {
+        FILE *list = fopen(source, "r");
+        char line[LINE_SIZE];
+
+        if(list == NULL)
+            return 0;
+        while(ok && fgets(line, LINE_SIZE, list) != NULL){
+            line[strcspn(line, "\r\n")] = '\0';
+            if(line[0] != '\0')
+                ok = addFile(run, &capacity, line, outdir);
+        }
+        fclose(list);
+    }
+    return ok;
+}
+
+/***********************************************************************************************************************
+ * int compareSize(const void *, const void *)
+ *
+ * Ordinamento dei file dal più grande al più piccolo (qsort).
+ */
+static int compareSize(const void *a, const void *b){
+    const struct batch_file *x = a, *y = b;
+    return (x->input_size < y->input_size) - (x->input_size > y->input_size);
+}
+
+/***********************************************************************************************************************
+ * int compareOutput(const void *, const void *)
+ * void rejectDuplicates(struct batch_run *)
+ *
+ * Controllo dei file di destinazione: outputName tiene solo il nome del file, quindi due file con lo stesso nome in
+ * cartelle diverse (o lo stesso file elencato due volte) avrebbero lo stesso file di destinazione, scritto da due
+ * thread insieme. I file vengono ordinati per file di destinazione (e per percorso) e di quelli con la stessa
+ * destinazione viene elaborato solo il primo: gli altri restano non elaborati (error) con un avviso.
+ */
+static int compareOutput(const void *a, const void *b){
+    const struct batch_file *x = a, *y = b;
+    int order = strcmp(x->output, y->output);
+    return order != 0 ? order : strcmp(x->input, y->input);
+}
+
+static void rejectDuplicates(struct batch_run *run){
+    int first = 0;
+
+    qsort(run->files, (size_t) run->n_files, sizeof(struct batch_file), compareOutput);
+    for(int i=1; i<run->n_files; i++){
+        if(strcmp(run->files[i].output, run->files[first].output) != 0){
+            first = i;
+            continue;
+        }
+        printf("!WARNING! %s has the same output file as %s (%s)\n", run->files[i].input, run->files[first].input,
+               run->files[i].output);
+        run->files[i].error = 1;
+    }
+}
+
+/***********************************************************************************************************************
+ * int takeTask(struct batch_worker *)
+ * int stealTask(struct batch_worker *)
+ *
+ * Prossimo file di un thread: takeTask lo prende dall'inizio della coda del thread, stealTask (quando la coda è vuota)
+ * ruba la metà dei file rimasti, arrotondata per eccesso, dalla fine della coda più lunga. Il primo file rubato viene
+ * restituito, gli altri vengono messi nella coda del thread.
+ * Nessun thread aggiunge file alla coda di un altro, quindi la coda del thread che ruba è vuota e i file rubati
+ * stanno sempre nel suo array.
+ *
+ * @param worker
+ * @return          --> indice del file, -1 se non ci sono più file
+ */
+static int takeTask(struct batch_worker *worker){
+    int task = -1;
+
+    pthread_mutex_lock(&worker->lock);
+    if(worker->head < worker->tail)
+        task = worker->tasks[worker->head++];
+    pthread_mutex_unlock(&worker->lock);
+    return task;
+}
+
+static int stealTask(struct batch_worker *worker){
+    struct batch_run *run = worker->run;
+    struct batch_worker *victim;
+    int longest, remaining, stolen, task;
+
+    for(;;){
+        //coda più lunga
+        victim = NULL;
+        longest = 0;
+        for(int i=0; i<run->n_workers; i++){
+            if(&run->workers[i] == worker)
+                continue;
+            pthread_mutex_lock(&run->workers[i].lock);
+            remaining = run->workers[i].tail - run->workers[i].head;
+            pthread_mutex_unlock(&run->workers[i].lock);
+            if(remaining > longest){
+                longest = remaining;
+                victim = &run->workers[i];
+            }
+        }
+        if(victim == NULL)
+            return -1;
+
+        //metà dei file dalla fine della coda (la coda può essersi accorciata nel frattempo). L'array del thread può
+        //essere scritto senza il suo lock perché la coda è vuota e nessuno lo legge; il lock viene preso solo dopo
+        //aver rilasciato quello dell'altro thread, quindi due thread non si aspettano mai a vicenda
+        pthread_mutex_lock(&victim->lock);
+        stolen = (victim->tail - victim->head + 1) / 2;
+        victim->tail -= stolen;
+        memcpy(worker->tasks, &victim->tasks[victim->tail], (size_t) stolen * sizeof(int));
+        pthread_mutex_unlock(&victim->lock);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->head = 0;
+        worker->tail = stolen;
+        pthread_mutex_unlock(&worker->lock);
+
+        if(stolen > 0){
+            worker->steals += (unsigned long long) stolen;
+            if((task = takeTask(worker)) >= 0)
+                return task;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * void processFile(struct batch_file *, struct lz77_context *, int)
+ *
+ * Compressione o decompressione di un file con il contesto del thread. Il file di destinazione di un file non
+ * elaborato viene cancellato.
+ */
+static void processFile(struct batch_file *file, struct lz77_context *context, int compress){
+    FILE *infile = fopen(file->input, "rb");
+    FILE *outfile = infile != NULL ? fopen(file->output, "wb") : NULL;
+
+    file->error = 1;
+    if(outfile != NULL){
+        if(compress)
+            file->error = !LZ77_compressFile(context, infile, outfile);
+        else
+            file->error = LZ77_decompressFile(context, infile, outfile);
+        file->output_size = ftell(outfile);
+        if(fclose(outfile) == EOF)
+            file->error = 1;
+        if(file->error)
+            remove(file->output);
+    }
+    if(infile != NULL)
+        fclose(infile);
+}
+
+/***********************************************************************************************************************
+ * void *batchWorker(void *)
+ *
+ * Lavoro di un thread: elabora i file della sua coda e poi quelli rubati agli altri thread, con un solo contesto.
+ */
+static void *batchWorker(void *arg){
+    struct batch_worker *worker = arg;
+    struct batch_run *run = worker->run;
+    struct lz77_context *context = LZ77_newContext();
+    struct batch_file *file;
+    int task;
+
+    if(context == NULL)
+        return NULL;
+    while((task = takeTask(worker)) >= 0 || (task = stealTask(worker)) >= 0){
+        file = &run->files[task];
+        processFile(file, context, run->compress);
+        worker->files++;
+        worker->bytes += (unsigned long long) (run->compress ? file->input_size : file->output_size);
+    }
+    LZ77_freeContext(context);
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * void batchReport(struct batch_run *, double)
+ *
+ * Stampa del riepilogo: file elaborati e non elaborati, byte, rapporto di compressione, throughput (byte originali al
+ * secondo) e lavoro di ogni thread.
+ */
+static void batchReport(struct batch_run *run, double seconds){
+    unsigned long long input = 0, output = 0, raw;
+    int failed = 0;
+
+    for(int i=0; i<run->n_files; i++){
+        if(run->files[i].error){
+            printf("!WARNING! %s has not been %s\n", run->files[i].input, run->compress ? "compressed" : "decompressed");
+            failed++;
+        } else {
+            input += (unsigned long long) run->files[i].input_size;
+            output += (unsigned long long) run->files[i].output_size;
+        }
+    }
+    raw = run->compress ? input : output;
+
+    printf("\nFiles: %d (%d ok, %d failed), %d threads\n", run->n_files, run->n_files - failed, failed,
+           run->n_workers);
+    printf("Input bytes: %llu\nOutput bytes: %llu\n", input, output);
+    if(input > 0)
+        printf("Ratio: %.2f%%\n", 100.0 * (double) output / (double) input);
+    printf("Time: %f [seconds]\n", seconds);
+    if(seconds > 0)
+        printf("Throughput: %.2f MB/s, %.1f files/s\n", (double) raw / seconds / 1048576.0,
+               (double) (run->n_files - failed) / seconds);
+
+    printf("\n%-8s %10s %14s %10s\n", "thread", "files", "bytes", "stolen");
+    for(int i=0; i<run->n_workers; i++)
+        printf("%-8d %10llu %14llu %10llu\n", i, run->workers[i].files, run->workers[i].bytes,
+               run->workers[i].steals);
+}
+
+/***********************************************************************************************************************
+ * int LZ77_batch(int, const char *, const char *, int)
+ *
+ * Compressione o decompressione di tutti i file di source (cartella o lista di file) nella cartella outdir, creata
+ * se non esiste, su threads thread (il thread chiamante è il primo). Alla fine viene stampato il riepilogo.
+ *
+ * @param compress  --> 1 compressione, 0 decompressione
+ * @param source
+ * @param outdir
+ * @param threads   --> da 1 a BATCH_MAX_THREADS, limitati al numero di file
+ * @return          --> 0 se tutti i file sono stati elaborati, 1 altrimenti
+ */
+int LZ77_batch(int compress, const char *source, const char *outdir, int threads){
+    struct batch_run run;
+    unsigned long long begin;
+    int per_worker, error = 0;
+
+    memset(&run, 0, sizeof(run));
+    run.compress = compress;
+    if(!listFiles(&run, source, outdir)){
+        printf("!WARNING! Cannot read the file list (%s)\n", source);
+        error = 1;
+    } else if(run.n_files == 0){
+        printf("!WARNING! No files found in %s\n", source);
+    } else if(mkdir(outdir, 0777) != 0 && errno != EEXIST){
+        printf("!WARNING! Cannot create the output folder (%s)\n", outdir);
+        error = 1;
+    }
+
+    //code dei thread: i file, dal più grande al più piccolo, vengono distribuiti a turno (tranne quelli rifiutati)
+    run.n_workers = threads < run.n_files ? threads : run.n_files;
+    per_worker = run.n_workers > 0 ? (run.n_files + run.n_workers - 1) / run.n_workers : 0;
+    if(!error && run.n_workers > 0){
+        rejectDuplicates(&run);
+        qsort(run.files, (size_t) run.n_files, sizeof(struct batch_file), compareSize);
+        run.workers = calloc((size_t) run.n_workers, sizeof(struct batch_worker));
+        for(int i=0; run.workers != NULL && i<run.n_workers; i++){
+            run.workers[i].run = &run;
+            pthread_mutex_init(&run.workers[i].lock, NULL);
+            if((run.workers[i].tasks = malloc((size_t) per_worker * sizeof(int))) == NULL)
+                error = 1;
+        }
+        if(run.workers == NULL || error){
+            printf("!WARNING! Cannot allocate the thread queues\n");
+            error = 1;
+        }
+    }
+
+    if(!error && run.n_workers > 0){
+        for(int i=0, n=0; i<run.n_files; i++){
+            struct batch_worker *worker = &run.workers[n % run.n_workers];
+            if(run.files[i].error)
+                continue;
+            worker->tasks[worker->tail++] = i;
+            n++;
+        }
+
+        begin = time_now_ns();
+        for(int i=1; i<run.n_workers; i++)
+            run.workers[i].started = pthread_create(&run.workers[i].thread, NULL, batchWorker, &run.workers[i]) == 0;
+        batchWorker(&run.workers[0]);       //i file dei thread non creati vengono rubati
+        for(int i=1; i<run.n_workers; i++)
+            if(run.workers[i].started)
+                pthread_join(run.workers[i].thread, NULL);
+        batchReport(&run, (double) (time_now_ns() - begin) / 1e9);
+
+        for(int i=0; i<run.n_files; i++)
+            if(run.files[i].error)
+                error = 1;
+    }
+
+    for(int i=0; run.workers != NULL && i<run.n_workers; i++){
+        pthread_mutex_destroy(&run.workers[i].lock);
+        free(run.workers[i].tasks);
+    }
+    free(run.workers);
+    for(int i=0; i<run.n_files; i++){
+        free(run.files[i].input);
+        free(run.files[i].output);
+    }
+    free(run.files);
+    return error;
+}
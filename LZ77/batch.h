@@ -0,0 +1,62 @@
+/***********************************************************************************************************************
+ *
+ *  batch.h
+ *
+ *  Compressione e decompressione di molti file in un solo processo (vedi batch.c).
+ *
+ **********************************************************************************************************************/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <pthread.h>
+#include "lz77.h"
+
+/*******************************************************DEFINE*********************************************************/
+
+#define BATCH_EXTENSION ".lz77"         //estensione dei file compressi
+#define BATCH_MAX_THREADS 256
+
+/*****************************************************STRUTTURE********************************************************/
+
+//File da comprimere o decomprimere
+struct batch_file
+{
+    char *input;
+    char *output;                   //nella cartella di destinazione, con o senza BATCH_EXTENSION
+    long long input_size;
+    long long output_size;
+    int error;                      //il file non è stato compresso / decompresso
+};
+
+//Coda di un thread: i file vengono presi dall'inizio dal thread stesso e rubati dalla fine dagli altri thread
+struct batch_worker
+{
+    pthread_mutex_t lock;
+    int *tasks;                     //indici dei file
+    int head, tail;                 //file ancora da elaborare: tasks[head] ... tasks[tail - 1]
+    pthread_t thread;
+    int started;
+    struct batch_run *run;
+    unsigned long long files;       //file elaborati dal thread
+    unsigned long long bytes;       //byte originali elaborati dal thread
+    unsigned long long steals;      //file rubati agli altri thread
+};
+
+//Lavoro di tutti i thread
+struct batch_run
+{
+    int compress;
+    struct batch_file *files;
+    int n_files;
+    struct batch_worker *workers;
+    int n_workers;
+};
+
+/******************************************************FUNZIONI********************************************************/
+
+int LZ77_batch(int compress, const char *source, const char *outdir, int threads);
+
+#endif
@@ -0,0 +1,1271 @@
+/***********************************************************************************************************************
+ *
+ *  lz77.c
+ *
+ *  Creato il: 30 ott 2017
+ *
+ *  Autore: Ivan Pavic
+ *
+ ***********************************************************************************************************************
+ *                                             ALGORITMO  DI COMPRESSIONE LZ77                                         *
+ ***********************************************************************************************************************
+ *
+ *  L'algoritmo LZ77 è un algoritmo di compressione a dizionario implicito che fa parte della famiglia dei
+ *  compressori senza perdita di informazioni (lossless).
+ *  L'algoritmo si basa sullo scorrimento di una finestra che contiene i dati che sono già stati codificati e un buffer
+ *  che contiene i dati da codificare.
+ *  L'obbiettivo è quello di andare a cercare le sequenze più lunghe possibili che sono contenute all'interno del buffer
+ *  muovendosi all'interno delle finestra. Il codice che si ottiene è il seguente:
+ *
+ *                      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+ *                      +                         prossimo carattere           +
+ *                      +                                 |                    +
+ *                      +|                        |       v |                 |+
+ *                      +|b c b c c c a b c a b b | a b c c | e a b b c a b c |+
+ *                      +|            *           | * * *   |                 |+
+ *                      +             ^                                        +
+ *                      +             |                                        +
+ *                      +           offset         lunghezza                   +
+ *                      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+ *
+ *  In questo caso si può vedere che l'offset vale 6, la lunghezza 3 e il carattere successivo alla sequenza è c.
+ *
+ ***********************************************************************************************************************
+ *
+ *  pseudo-codice dell'algoritmo LZ77:
+ *
+ *  1:  inizio
+ *  2:     riempimento buffer da file
+ *  3:     while (buffer non è vuoto) do
+ *  4:        cerca la sequenza più lunga possibile del buffer nella finestra
+ *  5:        o := offset
+ *  6:        l := lunghezza sequenza
+ *  7:        a := carattere successivo
+ *  8:        scrivo nel file compresso (o, l, a)
+ *  8:        aggiungi l+1 caratteri nella finestra
+ *  10:      end
+ *  11:  fine
+ *
+ ***********************************************************************************************************************
+ *                                              SCRITTURA BUFFERIZZATA                                                 *
+ ***********************************************************************************************************************
+ *
+ * La codifica generata dall'algoritmo è composta da 2 numeri interi e un char.
+ * Scrivendo su file una codifica del genere, il fattore di compressione sarebbe molto basso poichè un numero intero è
+ * rappresentato con 4 byte, la codifica dunque occuperebbe 4+4+1 = 9byte.
+ *
+ * Per ovviare a questa problematica ho implementato la scrittura bufferizzata che consiste nel trasformare i singoli
+ * elementi della codifica in binario e inserirli concatenati all'interno di un array di 8 celle.
+ * Le celle sono sequenze di 'zeri' e 'uno' che rappresentano 1 byte.
+ * Con un contatore globale viene tenuto conto l'indice in cui inserire i bit, quando il buffer viene riempito, il
+ * numero binario che rappresenta, viene convertito in decimale e scritto nel file compresso sottoforma di char.
+ *
+ * Grazie a questa conversione limito la dimensione con la quale vengono salvate le codifiche.
+ *
+ * Per limitare ulteriormente la dimensione delle codifiche, nel caso in cui la lunghezza della sequenza è 0, l'offset
+ * non viene bufferizzato poichè non sarà più rilevante nella fase di decompressione.
+ *
+ * Maggiori informazioni nella documentazione.
+ *
+ ***********************************************************************************************************************
+ *                                              FORMATO DEL FILE COMPRESSO                                             *
+ ***********************************************************************************************************************
+ *
+ * Il file compresso inizia con un'intestazione di STREAM_HEADER_SIZE byte: "LZ77", versione del formato,
+ * log2(WINDOW) e log2(LOOKAHEAD). Seguono i blocchi, ognuno con al massimo BLOCK_SIZE byte originali:
+ *
+ *                      +------+--------------------+--------------------+--------------------------+
+ *                      | tipo | byte originali (4) | byte del blocco (4)| codifiche o byte originali|
+ *                      +------+--------------------+--------------------+--------------------------+
+ *
+ * Gli interi sono scritti in little endian. Ogni blocco inizia all'inizio di un byte e può essere di due tipi:
+ *
+ * BLOCK_LZ77       codifiche bufferizzate, la finestra può comprendere i byte dei blocchi precedenti
+ * BLOCK_STORED     byte originali copiati così come sono
+ * BLOCK_INDEX      indice dei blocchi, solo alla fine dei file compressi per l'accesso casuale (vedi seek.c); il
+ *                  campo dei byte originali contiene il numero di voci dell'indice
+ *
+ * I dati incomprimibili (file casuali o già compressi) vengono riconosciuti dall'entropia dei byte e da una stima
+ * fatta con poche ricerche: per questi blocchi la ricerca delle sequenze non viene fatta e il blocco viene memorizzato
+ * così com'è, quindi il file compresso non è mai più grande dell'originale di più di qualche byte per blocco.
+ *
+ * ********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#define _POSIX_C_SOURCE 200809L     //open_memstream
+
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include "lz77.h"
+
+/**************************************************VARIABILI GLOBALI***************************************************/
+size_t context_memory=0;                            //vedi LZ77_newContext
+//una copia per ogni thread (modalità batch, vedi main.c)
+LZ_THREAD_LOCAL int bits=0;
+LZ_THREAD_LOCAL int decimal=0;
+LZ_THREAD_LOCAL int counter=0;
+LZ_THREAD_LOCAL int n_bits=0;                       //vedi la funzione extractCodes
+LZ_THREAD_LOCAL int buffer_position=BUFFER_SIZE;    //vedi la funzione extractCodes
+#if LZ_STATS
+LZ_THREAD_LOCAL struct lz77_stats lz77_stats;       //vedi struct lz77_stats
+#endif
+/**********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * struct lz77_context *LZ77_newContext()
+ * void LZ77_freeContext(struct lz77_context *)
+ *
+ * Creazione e distruzione di un contesto: i buffer vengono allocati solo al primo uso (vedi LZ77_compressFile e
+ * LZ77_decompressFile), un thread che comprime molti file alloca quindi i buffer una volta sola.
+ *
+ * Con un limite di memoria (context_memory, opzione --mem-limit di main.c) i buffer vengono dimensionati alla
+ * creazione del contesto: il buffer dei byte letti o decompressi riceve il limite meno un blocco (il blocco compresso
+ * in memoria da LZ77_compressBlock), le codifiche debufferizzate alla volta usano il resto. Il buffer non scende
+ * sotto MIN_STREAM_SIZE (la finestra e un blocco devono starci due volte) e le codifiche sotto MIN_BATCH, quindi un
+ * contesto usa almeno circa 200 KB. Il formato del file compresso non cambia.
+ *
+ * @return  --> contesto vuoto, NULL se la memoria non è sufficiente
+ */
+struct lz77_context *LZ77_newContext(){
+    struct lz77_context *context = calloc(1, sizeof(struct lz77_context));
+    size_t size;
+
+    if(context == NULL)
+        return NULL;
+    context->stream_size = STREAM_SIZE;
+    context->batch = BLOCK_SIZE;
+    if(context_memory > 0){
+        size = context_memory > BLOCK_SIZE ? context_memory - BLOCK_SIZE : 0;
+        context->stream_size = size < MIN_STREAM_SIZE ? MIN_STREAM_SIZE : size > STREAM_SIZE ? STREAM_SIZE : size;
+        size = context_memory > context->stream_size ? context_memory - context->stream_size : 0;
+        size = size / sizeof(struct code);
+        context->batch = size < MIN_BATCH ? MIN_BATCH : size > BLOCK_SIZE ? BLOCK_SIZE : size;
+    }
+    return context;
+}
+
+void LZ77_freeContext(struct lz77_context *context){
+    if(context == NULL)
+        return;
+    free(context->input);
+    free(context->decompressed);
+    free(context->codes);
+    free(context);
+}
+
+
+
+
+
+
+
+
+
+
+/***********************************************************************************************************************
+*                                                     COMPRESSIONE                                                     *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+*                                                       FUNZIONI                                                       *
+***********************************************************************************************************************/
+void inizializeCharArray(unsigned char array[], int size)
+{
+    for(int i=0; i<size; i++)
+        array[i]='\0';
+}
+
+void inizializeArray(int array [], int size)
+{
+    for(int i=0; i<size; i++)
+        array[i]=0;
+}
+
+/***********************************************************************************************************************
+ * size_t readBytes(unsigned char *, size_t, FILE *)
+ * void writeBytes(const unsigned char *, size_t, FILE *)
+ *
+ * Lettura e scrittura a blocchi dei file, separate dal resto del codice per poterne misurare il tempo (PHASE_TIMING).
+ */
+size_t readBytes(unsigned char *bytes, size_t size, FILE *infile)
+{
+    PHASE_PUSH(PHASE_READ);
+    size_t readed = fread(bytes, sizeof(unsigned char), size, infile);
+    PHASE_POP();
+    return readed;
+}
+
+void writeBytes(const unsigned char *bytes, size_t size, FILE *outfile)
+{
+    PHASE_PUSH(PHASE_WRITE);
+    fwrite(bytes, sizeof(unsigned char), size, outfile);
+    PHASE_POP();
+}
+
+/***********************************************************************************************************************
+ * int binToDec(int)
+ *
+ * Questa funzione converte in decimale i byte generati dalla scrittura bufferizzata. Il valore decimale ritornato
+ * viene scritto nel file compresso sottoforma di char.
+ *
+ * @param buffer
+ * @return decimal
+ *
+ */
+int binToDec(int buffer[])
+{
+    int decimal=0;
+    for(int i=BUFFER_SIZE-1; i>=0; i--)
+        decimal = decimal + ( buffer[BUFFER_SIZE-1-i] * ((int) pow(2,i) ));
+    return decimal;
+}
+
+/***********************************************************************************************************************
+ * void fillBuffer(int[], int, FILE *)
+ *
+ * Funzione che gestisce il riempimento del buffer, il quale rappresenta 1 byte, per la scrittura bufferizzata.
+ * L'argomento bit viene scritto alla posizione giusta grazie alla variabile globale bits che viene incrementata dopo
+ * ogni inserimento.
+ * Se il buffer viene riempito completamente, viene ricavato il suo valore decimale e questo valore viene scritto sul
+ * file compresso.
+ * Segue l'inizializzazione del buffer e l'azzeramento del contatore di posizione: "bits".
+ *
+ * @param buffer
+ * @param bit
+ * @param outfile
+ */
+void fillBuffer(int buffer[], int bit, FILE *outfile){
+    if(bits<BUFFER_SIZE){
+        buffer[bits] = bit;
+        bits++;
+    }else if(bits==BUFFER_SIZE)
+    {
+        decimal = binToDec(buffer);
+        PHASE_PUSH(PHASE_WRITE);
+        fputc(decimal, outfile);
+        PHASE_POP();
+        inizializeArray(buffer, BUFFER_SIZE);
+        bits=0;
+        buffer[bits]=bit;
+        bits++;
+    }
+}
+
+/***********************************************************************************************************************
+ * void decToBin(int, int, int, FILE *)
+ *
+ * Ogni singolo elemento della codifica (struct code) viene passato a questa funzione per essere convertito in binario.
+ * La funzione ricava i bit degli elementi di codifica e li passa uno ad uno alla funzione fillBuffer.
+ *
+ * @param buffer
+ * @param n         --> elemento della codifica da convertire in binario
+ * @param b_size    --> numero di bit necessari per rappresentare l'elemento di codifica
+ * @param outfile
+ */
+void decToBin(int buffer[], int n, int b_size, FILE  *outfile)
+{
+    PHASE_PUSH(PHASE_PACK);
+    for(int i=b_size-1; i>=0; i--)
+    {
+        if(n >=((int)pow(2,i)) )
+        {
+            fillBuffer(buffer, 1, outfile);
+            n = n - ((int) pow(2, i));
+        }else
+            fillBuffer(buffer, 0, outfile);
+    }
+    PHASE_POP();
+}
+
+/***********************************************************************************************************************
+ * int bufferizedWriting(struct code *, int *, FILE *)
+ *
+ * Se la lunghezza della sequenza è nulla la codifica bufferizzata è la seguente: (length, nextchar)
+ * Altrimenti: (length, offset, nextchar)
+ *
+ * @param code      --> struttura contenente la codifica da bufferizzare
+ * @param buffer    --> byte buffer
+ * @param outfile
+ * @return          --> check value
+ */
+int bufferizedWriting(struct code *code, int *buffer, FILE *outfile)
+{
+    PHASE_PUSH(PHASE_ENCODE);
+    STATS_INC(lz77_stats.tokens);
+    STATS_ADD(lz77_stats.bytes, code->l + 1);
+    STATS_HIST(lz77_stats.length_hist, code->l, LOOKAHEAD);
+    if(code->l==0)
+    {
+        STATS_INC(lz77_stats.literals);
+        //printf("\n%d) (%d, 0, %c)", counter, code->l, code->a);
+        decToBin(buffer, code->l, ((int) log2(LOOKAHEAD)), outfile);
+        decToBin(buffer, code->a, sizeof(unsigned char)*8, outfile);
+        //counter++;
+    }else
+    {
+        STATS_LOG2(lz77_stats.offset_hist, code->o);
+        //printf("\n%d) (%d, %d, %c)", counter, code->l, code->o, code->a);
+        decToBin(buffer, code->l, ((int) log2(LOOKAHEAD)), outfile);
+        decToBin(buffer, code->o-1, ( (int) log2(WINDOW)), outfile);
+        decToBin(buffer, code->a, sizeof(unsigned char)*8, outfile);
+        //counter++;
+    }
+    PHASE_POP();
+
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * void flushBits(int [], FILE *)
+ *
+ * Scrittura dell'ultimo byte (eventualmente incompleto) della scrittura bufferizzata: i bit mancanti valgono 0.
+ * Dopo la scrittura il buffer è vuoto, il blocco successivo inizia quindi sempre all'inizio di un byte.
+ *
+ * @param buffer
+ * @param outfile
+ */
+void flushBits(int buffer[], FILE *outfile)
+{
+    if(bits!=0){
+        decimal = binToDec(buffer);
+        PHASE_PUSH(PHASE_WRITE);
+        fputc(decimal, outfile);
+        PHASE_POP();
+        inizializeArray(buffer, BUFFER_SIZE);
+        bits=0;
+    }
+}
+
+/***********************************************************************************************************************
+ * void writeUint32(unsigned long, FILE *)
+ * unsigned long readUint32(FILE *, int *)
+ *
+ * Scrittura e lettura degli interi a 32 bit delle intestazioni (little endian, indipendente dalla macchina).
+ */
+void writeUint32(unsigned long value, FILE *outfile)
+{
+    for(int i=0; i<4; i++)
+        fputc((int) ((value >> (8*i)) & 0xFF), outfile);
+}
+
+unsigned long readUint32(FILE *infile, int *eof)
+{
+    unsigned long value = 0;
+    for(int i=0; i<4; i++){
+        int c = fgetc(infile);
+        if(c==EOF){
+            *eof = 1;
+            return 0;
+        }
+        value |= (unsigned long) c << (8*i);
+    }
+    return value;
+}
+
+/***********************************************************************************************************************
+ * void writeUint64(unsigned long long, FILE *)
+ * unsigned long long readUint64(FILE *, int *)
+ *
+ * Come writeUint32 e readUint32, per le posizioni dell'indice dei blocchi (vedi seek.c).
+ */
+void writeUint64(unsigned long long value, FILE *outfile)
+{
+    writeUint32((unsigned long) (value & 0xFFFFFFFFUL), outfile);
+    writeUint32((unsigned long) (value >> 32), outfile);
+}
+
+unsigned long long readUint64(FILE *infile, int *eof)
+{
+    unsigned long long low = readUint32(infile, eof);
+    return low | (unsigned long long) readUint32(infile, eof) << 32;
+}
+
+/***********************************************************************************************************************
+ * void writeStreamHeader(FILE *)
+ *
+ * Intestazione del file compresso: LZ77_MAGIC, LZ77_VERSION, log2(WINDOW) e log2(LOOKAHEAD). Il decompressore
+ * controlla che il file sia stato compresso con la stessa finestra e lo stesso lookahead.
+ *
+ * @param outfile
+ */
+void writeStreamHeader(FILE *outfile)
+{
+    fputs(LZ77_MAGIC, outfile);
+    fputc(LZ77_VERSION, outfile);
+    fputc((int) log2(WINDOW), outfile);
+    fputc((int) log2(LOOKAHEAD), outfile);
+}
+
+/***********************************************************************************************************************
+ * int findLongestMatch(unsigned char *, unsigned char *, unsigned char *, struct code *)
+ *
+ * Ricerca della sequenza più lunga (vedi LZ77_compressor per il significato dei puntatori).
+ * w_cursor parte dal lookahead e si muove all'indietro fino a window, ogni volta che il byte puntato da w_cursor è
+ * uguale al primo byte del lookahead, i byte che seguono vengono confrontati finchè sono uguali (al massimo
+ * LOOKAHEAD-1 byte). A parità di lunghezza vince la sequenza più vicina, quando viene trovata una sequenza della
+ * lunghezza massima la ricerca si ferma.
+ *
+ * La sequenza lascia sempre almeno un byte (il carattere successivo) prima di endOfBuffer.
+ *
+ * @param lookahead
+ * @param window
+ * @param endOfBuffer   --> primo byte dopo la fine dei dati da codificare
+ * @param match         --> sequenza trovata: lunghezza, offset e carattere successivo (lunghezza 0 se non trovata)
+ * @return              --> numero di posizioni della finestra confrontate
+ */
+int findLongestMatch(unsigned char *lookahead, unsigned char *window, unsigned char *endOfBuffer, struct code *match)
+{
+    unsigned char *w_cursor = lookahead;   //puntatore che si muove nel search-buffer
+    int max_length = LOOKAHEAD - 1;
+    int l_counter;
+    int w_counter = 0;
+
+    match->o = 0;
+    match->l = 0;
+    if(endOfBuffer - lookahead - 1 < max_length)
+        max_length = (int) (endOfBuffer - lookahead - 1);
+
+    while(w_cursor != window && match->l < max_length){
+        w_cursor--;
+        w_counter++;
+        if(*w_cursor == *lookahead){
+            //muovo in parallelo i due cursori finchè il loro valore è uguale
+            l_counter = 1;
+            while(l_counter < max_length && w_cursor[l_counter] == lookahead[l_counter])
+                l_counter++;
+
+            if(l_counter > match->l){           //controllo se nuova sequenza è > di vecchia sequenza.
+                match->l = l_counter;
+                match->o = w_counter;
+            }
+        }
+    }
+
+    if(match->l > 0)
+        match->a = lookahead[match->l];
+
+    return w_counter;
+}
+
+/***********************************************************************************************************************
+ * double blockEntropy(const unsigned char *, size_t)
+ *
+ * Entropia (in bit per byte) della distribuzione dei byte di un blocco: valori vicini a 8 indicano dati casuali o già
+ * compressi, sui quali le codifiche letterali (11 bit per byte) espanderebbero i dati.
+ *
+ * @param block
+ * @param size
+ * @return
+ */
+double blockEntropy(const unsigned char *block, size_t size)
+{
+    unsigned long histogram[256];
+    double entropy = 0;
+
+    memset(histogram, 0, sizeof(histogram));
+    for(size_t i=0; i<size; i++)
+        histogram[block[i]]++;
+
+    for(int i=0; i<256; i++){
+        if(histogram[i]!=0){
+            double p = (double) histogram[i] / (double) size;
+            entropy -= p * log2(p);
+        }
+    }
+    return entropy;
+}
+
+/***********************************************************************************************************************
+ * double sampleMatchCost(unsigned char *, size_t, size_t)
+ *
+ * Stima del costo della compressione di un blocco: in MATCH_SAMPLES posizioni distribuite su tutto il blocco viene
+ * fatta la ricerca della sequenza più lunga e si calcola quanti bit costerebbe ogni byte con la codifica trovata
+ * (codifica letterale: log2(LOOKAHEAD)+8 bit per 1 byte, sequenza: log2(LOOKAHEAD)+log2(WINDOW)+8 bit per l+1 byte).
+ *
+ * @param block
+ * @param size
+ * @param history   --> byte già codificati disponibili prima del blocco
+ * @return          --> stima dei bit per byte (>= 8 se la compressione non conviene)
+ */
+double sampleMatchCost(unsigned char *block, size_t size, size_t history)
+{
+    struct code match;
+    double cost = 0;
+
+    for(int i=0; i<MATCH_SAMPLES; i++){
+        unsigned char *lookahead = block + (size * (size_t) i) / MATCH_SAMPLES;
+        size_t before = (size_t) (lookahead - block) + history;
+        unsigned char *window = lookahead - (before < WINDOW ? before : WINDOW);
+
+        findLongestMatch(lookahead, window, block + size, &match);
+        if(match.l == 0)
+            cost += (log2(LOOKAHEAD) + 8);
+        else
+            cost += (log2(LOOKAHEAD) + log2(WINDOW) + 8) / (match.l + 1);
+    }
+    return cost / MATCH_SAMPLES;
+}
+
+/***********************************************************************************************************************
+ * void encodeBlock(unsigned char *, size_t, size_t, FILE *)
+ *
+ * Ricerca delle sequenze e scrittura bufferizzata delle codifiche di un blocco.
+ * Per ogni posizione del lookahead viene cercata la sequenza più lunga nella finestra (che può comprendere anche i
+ * byte dei blocchi precedenti), viene scritta la codifica e il lookahead viene spostato di lunghezza+1 byte.
+ *
+ * @param block
+ * @param size
+ * @param history   --> byte già codificati disponibili prima del blocco
+ * @param outfile
+ */
+void encodeBlock(unsigned char *block, size_t size, size_t history, FILE *outfile)
+{
+    unsigned char *endOfBuffer = block + size;     //fine del blocco
+    unsigned char *start = block - history;        //primo byte disponibile per la finestra
+    unsigned char *lookahead = block;              //inizio look-ahead
+    unsigned char *window;                         //inizio search-buffer
+    struct code code;
+    int probes;
+
+    //Buffered Writing Array
+    int buffer[BUFFER_SIZE];
+    inizializeArray(buffer,BUFFER_SIZE);
+    bits=0;
+
+    PHASE_PUSH(PHASE_SEARCH);
+    while(lookahead < endOfBuffer){
+        window = (lookahead - start) > WINDOW ? lookahead - WINDOW : start;
+
+        probes = findLongestMatch(lookahead, window, endOfBuffer, &code);
+        STATS_INC(lz77_stats.searches);
+        STATS_ADD(lz77_stats.probes, probes);
+        STATS_LOG2(lz77_stats.probes_hist, probes);
+        (void) probes;      //usato solo per le statistiche (LZ_STATS)
+
+        //Se non viene trovata alcuna sequenza codice: (0, 0, valore lookahead)
+        if(code.l == 0)
+            code.a = *lookahead;
+
+        bufferizedWriting(&code, buffer, outfile);     //bufferizzazione della codifica
+
+        //SLIDING LOOKAHEAD
+        lookahead = lookahead + (code.l + 1);
+    }
+    PHASE_POP();
+
+    //Scrittura dell'ultimo byte del blocco
+    flushBits(buffer, outfile);
+}
+
+/***********************************************************************************************************************
+ * int LZ77_compressBlock(unsigned char *, size_t, size_t, FILE *)
+ *
+ * Compressione di un blocco con la scelta tra blocco LZ77 e blocco memorizzato così com'è (BLOCK_STORED):
+ *
+ * 1. se l'entropia dei byte del blocco è bassa il blocco viene sempre compresso;
+ * 2. altrimenti la stima fatta su alcune posizioni (sampleMatchCost) decide se vale la pena cercare le sequenze, per i
+ *    dati incomprimibili la ricerca non viene nemmeno fatta;
+ * 3. se il blocco compresso non è più piccolo del blocco originale viene comunque memorizzato così com'è.
+ *
+ * In questo modo un blocco non occupa mai più di BLOCK_HEADER_SIZE byte in più rispetto ai dati originali.
+ *
+ * @param block
+ * @param size      --> byte del blocco (al massimo BLOCK_SIZE)
+ * @param history   --> byte già codificati disponibili prima del blocco
+ * @param outfile
+ * @return          --> tipo del blocco scritto (BLOCK_STORED o BLOCK_LZ77)
+ */
+int LZ77_compressBlock(unsigned char *block, size_t size, size_t history, FILE *outfile)
+{
+    char *packed = NULL;            //codifiche del blocco
+    size_t packed_size = 0;
+    int type = BLOCK_LZ77;
+    FILE *stream;
+
+    PHASE_PUSH(PHASE_SEARCH);
+    if(blockEntropy(block, size) >= ENTROPY_THRESHOLD && sampleMatchCost(block, size, history) >= 8)
+        type = BLOCK_STORED;
+    PHASE_POP();
+
+    if(type == BLOCK_LZ77){
+        stream = open_memstream(&packed, &packed_size);
+        if(stream == NULL){
+            type = BLOCK_STORED;
+        } else {
+            encodeBlock(block, size, history, stream);
+            fclose(stream);
+            if(packed_size >= size)
+                type = BLOCK_STORED;
+        }
+    }
+
+    fputc(type, outfile);
+    writeUint32((unsigned long) size, outfile);
+    if(type == BLOCK_LZ77){
+        writeUint32((unsigned long) packed_size, outfile);
+        writeBytes((unsigned char *) packed, packed_size, outfile);
+    } else {
+        STATS_INC(lz77_stats.stored_blocks);
+        STATS_ADD(lz77_stats.stored_bytes, size);
+        writeUint32((unsigned long) size, outfile);
+        writeBytes(block, size, outfile);
+    }
+    STATS_INC(lz77_stats.blocks);
+
+    free(packed);
+    return type;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_compressFile(struct lz77_context *, FILE*, FILE*)
+ *
+ * Il file "infile" passato come argomento viene letto con la funzione di libreria fread che riempie un buffer con
+ * i byte da comprimere, il buffer viene poi diviso in blocchi di BLOCK_SIZE byte compressi uno alla volta
+ * (vedi LZ77_compressBlock).
+ * La ricerca della sequenza più lunga (findLongestMatch) è svolta muovendo una serie di puntatori all'interno del
+ * buffer, la finestra può comprendere anche i byte dei blocchi precedenti.
+ *
+ * Dopo aver controllato tutta la finestra, il codice legato all'ultima sequenza più lunga trovata viene mandato alle
+ * funzioni per la scrittura bufferizzata.
+ * A questo punto viene effettuato uno "sliding" dei puntatori di lunghezza+1 per caricare il look-ahead buffer con i
+ * nuovi byte da comprimere e espellere lo stesso numero di byte dal searchbuffer,
+ *
+ * Quando nel buffer rimane meno di un blocco da comprimere, gli ultimi WINDOW byte già compressi vengono spostati
+ * all'inizio del buffer e il resto viene riempito di nuovo con fread.
+ *
+ *
+ *                          +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *                          + window                  lookahead                           +
+ *                          +    |                        |                               +
+ *                          +    v                        v                               +
+ *                          +                                                             +
+ *                          +    |                        |         |                 |   +
+ *                          +    |b c b c c c a b c a b b | a b c c | e a b b c a b c |   +
+ *                          +    |            *           | * * *   |                 |   +
+ *                          +                                                             +
+ *                          +                 ^                 ^                         +
+ *                          +                 |                 |                         +
+ *                          +              w_cursor           l_cursor                    +
+ *                          +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ * Puntatori utilizzati:
+ *
+ * lookahead        inizio lookahead buffer, da qui partono tutte le ricerche.
+ * window           inizio della finestra.
+ * l_cursor         puntatore che si muove nel lookahead.
+ * w_cursor         puntatore che si muove nella finestra per segnare l'inizio della sequenza.
+ * endOfBuffer      puntatore al primo byte dopo la fine del blocco.
+ *
+ * Il buffer dei byte letti è quello del contesto (vedi LZ77_newContext), allocato al primo uso e riutilizzato per i
+ * file successivi.
+ *
+ * @param context
+ * @param infile
+ * @param outfile
+ * @return          --> 1 se il file è stato compresso, 0 se la memoria non è sufficiente
+ */
+int LZ77_compressFile(struct lz77_context *context, FILE *infile, FILE *outfile){
+
+    //VARIABLES
+    unsigned char *bytes_from_file;     //Array che contiene i byte letti dal file di input
+    size_t filled=0;            //byte presenti in bytes_from_file
+    size_t position=0;          //inizio del prossimo blocco da comprimere
+    size_t readed;
+    size_t size;
+    int eof=0;
+
+    if(context->input == NULL)
+        context->input = malloc(context->stream_size);
+    if((bytes_from_file = context->input) == NULL){
+        printf("!WARNING! Cannot allocate the input buffer.\n");
+        return 0;
+    }
+
+    writeStreamHeader(outfile);
+
+    while(1) {
+
+        //RIEMPIMENTO BUFFER: tengo gli ultimi WINDOW byte già compressi (searchbuffer) e leggo i nuovi byte
+        if(!eof && filled - position < BLOCK_SIZE){
+            if(position > WINDOW){
+                memmove(bytes_from_file, bytes_from_file + position - WINDOW, filled - position + WINDOW);
+                filled = filled - position + WINDOW;
+                position = WINDOW;
+            }
+            readed = readBytes(bytes_from_file + filled, context->stream_size - filled, infile);
+            if(readed == 0)
+                eof = 1;
+            filled += readed;
+            continue;
+        }
+
+        if(position == filled)
+            break;
+
+        size = filled - position < BLOCK_SIZE ? filled - position : BLOCK_SIZE;
+        LZ77_compressBlock(bytes_from_file + position, size, position < WINDOW ? position : WINDOW, outfile);
+        position += size;
+    }
+
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_compressor(FILE*, FILE*)
+ *
+ * Compressione di un solo file con un contesto temporaneo (vedi LZ77_compressFile).
+ *
+ * @param infile
+ * @param outfile
+ * @return          --> 1 se il file è stato compresso, 0 se la memoria non è sufficiente
+ */
+int LZ77_compressor(FILE *infile, FILE *outfile){
+    struct lz77_context *context = LZ77_newContext();
+    int ok;
+
+    if(context == NULL){
+        printf("!WARNING! Cannot allocate the input buffer.\n");
+        return 0;
+    }
+    ok = LZ77_compressFile(context, infile, outfile);
+    LZ77_freeContext(context);
+    return ok;
+}
+
+
+
+
+
+
+
+
+
+
+
+/***********************************************************************************************************************
+                                                   DECOMPRESSIONE
+***********************************************************************************************************************/
+
+void initializeCharArray(unsigned char *array, int size){
+
+    for(int i=0; i<size; i++)
+    {
+        array[i]='\0';
+    }
+}
+
+void initializeIntArray(int *array, int size){
+
+    for(int i=0; i<size; i++)
+        array[i]=0;
+}
+
+/***********************************************************************************************************************
+ * void fillBuffer_d(int [], int)
+ *
+ * questa funzione riempie il buffer per la lettura bufferizzata, l'unica differenza rispetto alla funzione fillBuffer
+ * della scrittura bufferizzata è il fatto che non è necessario gestire la conversione da binario a decimale visto che
+ * il buffer non viene usato per scrivere codici su file ma solo per ricavare i bit delle codifiche.
+ *
+ * @param buffer //buffer contentente i bit debufferizzati
+ * @param bit    //bit bufferizzato da inserire
+ */
+void fillBuffer_d(int buffer[], int bit){
+    if(bits<BUFFER_SIZE)
+    {
+        buffer[bits] = bit;
+        bits++;
+    }
+}
+
+int getNextCode(FILE **infile){
+    PHASE_PUSH(PHASE_READ);
+    int c = fgetc(*infile);
+    PHASE_POP();
+    return c;
+}
+
+/***********************************************************************************************************************
+ * void decToBin_d(int [], int, int)
+ *
+ * Stesso funzionamento di decToBin.
+ *
+ * @param buffer    //buffer in cui inserire i bit debufferizzati
+ * @param n         //numero decimale in cui sono bufferizzati gli elementi di codifica
+ * @param b_size
+ */
+void decToBin_d(int buffer[], int n, int b_size){
+    for(int i=b_size-1; i>=0; i--)
+    {
+        if(n >=((int)pow(2,i)) )
+        {
+            fillBuffer_d(buffer, 1);
+            n = n - ((int) pow(2, i));
+        }else
+            fillBuffer_d(buffer, 0);
+    }
+    bits=0;
+}
+
+/***********************************************************************************************************************
+ * int extractCodes(int [], FILE *)
+ *
+ * Funzione fondamentale per la decompressione.
+ * Il buffer che contiene i bit debufferizzati viene passato come argomento e la variabile globale n_bits indica quanti
+ * bit è necessario estrapolare dal buffer.
+ * Con la variabile globale buffer_position si tiene conto della posizione in cui bisogna prendere il bit, una volta
+ * presi tutti i bit (buffer_position = 0) viene letto il nuovo byte da debufferizzare e viene effettuata la conversione
+ * decimale a binario per caricare il buffer con i nuovi bit.
+ *
+ * Ad ogni ciclo viene aggiornato il valore di decimal sommando la nuova potenza di 2.
+ *
+ * Esempio:
+ * buffer[] = 0 0 0 1 0 1 1 0           ----> decimal = 2^4 + 2^2 + 2^1 = 20
+ *
+ * Chiaramente il peso di ogni bit non dipende da buffer_position ma viene ricalcolato ogni volta in base a n_bits.
+ *
+ * n_bits varia in base all'elemento di codifica che vogliamo estrapolare:
+ *
+ * -offset (o): log2(WINDOW)    --> dipende dalla grandezza del searchbuffer
+ * -length (l): log2(LOOKAHEAD) --> dipende dalla grandezza del look-ahead buffer
+ * -nextchar (a): 8             --> caratteri ASCII sono rappresentabili con 1byte
+ *
+ *
+ *
+ * @param buffer    --> buffer contenente i bit debufferizzati
+ * @param infile
+ * @return          --> ritorna il decimale che rappresenta l'elemento di codifica che si vuole estrarre
+ */
+int extractCodes(int buffer[], FILE *infile){
+    n_bits--;
+    int decimal = 0, c=0;
+
+    while(n_bits>=0){
+
+        if(buffer_position==0) {
+            buffer_position=8;
+
+            c=getNextCode(&infile);
+            //se i codici sono finiti ritorna EOF
+            if(c!=EOF) {
+                decToBin_d(buffer, c, BUFFER_SIZE);
+            }else {
+                return EOF;
+            }
+        }
+
+        //conversione binario/decimale
+        decimal = decimal + ( (buffer[8-buffer_position]) * ((int) pow(2,n_bits) ));
+
+        n_bits--;
+        buffer_position--;
+    }
+    return decimal;
+}
+
+/***********************************************************************************************************************
+ * unsigned char *copyMatch(unsigned char *, int, int)
+ *
+ * Copia della sequenza di una codifica: il puntatore w_cursor torna indietro di offset byte rispetto al lookahead e
+ * i due puntatori vengono mossi in parallelo per length byte.
+ * La copia è fatta byte per byte perchè la sequenza può sovrapporsi ai byte che vengono scritti (offset < length).
+ *
+ * @param d_lookahead   --> posizione in cui scrivere la sequenza
+ * @param offset
+ * @param length
+ * @return              --> nuova posizione del lookahead
+ */
+unsigned char *copyMatch(unsigned char *d_lookahead, int offset, int length){
+    unsigned char *w_cursor = d_lookahead - offset;
+    int i = 0;
+    while(i < length){
+        *d_lookahead = *w_cursor;
+        d_lookahead++;
+        w_cursor++;
+        i++;
+    }
+    return d_lookahead;
+}
+
+/***********************************************************************************************************************
+ * unsigned char *flushDecompressed(unsigned char *, unsigned char *, unsigned char **, FILE *)
+ *
+ * Reinizializzazione dell'array decompressed: i byte non ancora scritti vengono scritti su file, poi gli ultimi WINDOW
+ * byte (il search buffer, necessario per le prossime codifiche) vengono copiati all'inizio dell'array.
+ *
+ * @param decompressed  --> array dei byte decompressi
+ * @param d_lookahead   --> posizione attuale del lookahead (almeno WINDOW byte dopo l'inizio di decompressed)
+ * @param written       --> primo byte non ancora scritto su file, aggiornato
+ * @param outfile
+ * @return              --> nuova posizione del lookahead
+ */
+unsigned char *flushDecompressed(unsigned char *decompressed, unsigned char *d_lookahead, unsigned char **written,
+                                 FILE *outfile){
+    writeBytes(*written, d_lookahead - *written, outfile);
+    memmove(decompressed, d_lookahead - WINDOW, WINDOW);
+    *written = &decompressed[WINDOW];
+    return &decompressed[WINDOW];
+}
+
+/***********************************************************************************************************************
+ * int readStreamHeader(FILE *)
+ *
+ * Lettura e controllo dell'intestazione del file compresso (vedi writeStreamHeader).
+ *
+ * @param infile
+ * @return          --> 1 se l'intestazione è valida, 0 altrimenti
+ */
+int readStreamHeader(FILE *infile){
+    unsigned char header[STREAM_HEADER_SIZE];
+
+    if(readBytes(header, STREAM_HEADER_SIZE, infile) != STREAM_HEADER_SIZE)
+        return 0;
+    return memcmp(header, LZ77_MAGIC, 4) == 0 && header[4] == LZ77_VERSION &&
+           header[5] == (int) log2(WINDOW) && header[6] == (int) log2(LOOKAHEAD);
+}
+
+/***********************************************************************************************************************
+ * long unpackBlock(struct code [], size_t, size_t, size_t, size_t *, size_t *, int [], FILE *)
+ *
+ * Debufferizzazione delle codifiche di un blocco BLOCK_LZ77: le codifiche vengono lette (vedi extractCodes) fino a
+ * quando non coprono tutti i byte originali del blocco o non riempiono l'array d (batch codifiche), il blocco viene
+ * quindi letto in più volte se batch è più piccolo del blocco. covered, read_bits e buffer restano al chiamante tra
+ * una chiamata e l'altra.
+ * Ogni codifica viene controllata prima di essere usata: la sequenza non deve iniziare prima dei byte già
+ * decompressi e non deve superare la fine del blocco.
+ *
+ * @param d             --> array in cui inserire le codifiche
+ * @param batch         --> elementi di d
+ * @param raw_size      --> byte originali del blocco
+ * @param history       --> byte già decompressi disponibili prima del blocco
+ * @param covered       --> byte originali coperti dalle codifiche lette finora, aggiornato
+ * @param read_bits     --> bit letti finora, aggiornato
+ * @param buffer        --> bit del byte in lettura (BUFFER_SIZE elementi)
+ * @param infile
+ * @return              --> numero di codifiche lette, -1 se il blocco è troncato o non valido
+ */
+long unpackBlock(struct code d[], size_t batch, size_t raw_size, size_t history, size_t *covered, size_t *read_bits,
+                 int buffer[], FILE *infile){
+    long s = 0;
+    int decimal;
+
+    PHASE_PUSH(PHASE_UNPACK);
+    while(*covered < raw_size && (size_t) s < batch){
+        n_bits = (int) log2(LOOKAHEAD);
+        decimal = extractCodes(buffer, infile);
+        *read_bits += (size_t) log2(LOOKAHEAD);
+        if(decimal == EOF)
+            break;
+        d[s].l = decimal;
+        d[s].o = 0;
+
+        if(decimal != 0){
+            n_bits = (int) log2(WINDOW);
+            decimal = extractCodes(buffer, infile);
+            *read_bits += (size_t) log2(WINDOW);
+            if(decimal == EOF)
+                break;
+            d[s].o = decimal + 1; //Sommo 1 perchè nella scrittura bufferizzata toglievo 1 per poterlo rappresentare al massimo
+        }
+
+        n_bits = 8;
+        decimal = extractCodes(buffer, infile);
+        *read_bits += 8;
+        if(decimal == EOF)
+            break;
+        d[s].a = (unsigned char) decimal;
+
+        if((size_t) d[s].l + 1 > raw_size - *covered || (size_t) d[s].o > history + *covered)
+            break;
+        *covered += (size_t) d[s].l + 1;
+        s++;
+    }
+    PHASE_POP();
+
+    if(*covered < raw_size && (size_t) s < batch)
+        return -1;
+    return s;
+}
+
+/***********************************************************************************************************************
+ * unsigned char *decodeBlock(int, size_t, size_t, struct code [], size_t, unsigned char *, unsigned char *, FILE *)
+ *
+ * Decompressione di un blocco a partire da d_lookahead: i blocchi BLOCK_STORED vengono copiati direttamente, per i
+ * blocchi BLOCK_LZ77 le codifiche vengono debufferizzate e inserite nell'array di strutture d[] (vedi unpackBlock),
+ * poi il vero e proprio algoritmo di decompressione prende codifica per codifica e in base ai valori di length,
+ * offset e nextchar scrive i byte (vedi copyMatch). Con un array d più piccolo del blocco le due fasi si alternano a
+ * gruppi di batch codifiche.
+ * Alla fine i bit letti devono corrispondere ai byte del blocco.
+ *
+ * @param type          --> BLOCK_STORED o BLOCK_LZ77
+ * @param raw_size      --> byte originali del blocco
+ * @param packed_size   --> byte del blocco nel file compresso
+ * @param d             --> array per le codifiche
+ * @param batch         --> elementi di d (almeno 1)
+ * @param start         --> primo byte decompresso che la finestra può usare
+ * @param d_lookahead   --> posizione in cui scrivere il blocco (almeno raw_size byte disponibili)
+ * @param infile
+ * @return              --> nuova posizione del lookahead, NULL se il blocco è troncato o non valido
+ */
+unsigned char *decodeBlock(int type, size_t raw_size, size_t packed_size, struct code d[], size_t batch,
+                           unsigned char *start, unsigned char *d_lookahead, FILE *infile){
+    int buffer[BUFFER_SIZE];
+    size_t history = (size_t) (d_lookahead - start);
+    size_t covered = 0;         //byte originali coperti dalle codifiche lette
+    size_t read_bits = 0;
+    long s;
+
+    if(type == BLOCK_STORED){
+        if(readBytes(d_lookahead, raw_size, infile) != raw_size)
+            return NULL;
+        return d_lookahead + raw_size;
+    }
+
+    initializeIntArray(buffer, BUFFER_SIZE);
+    buffer_position = 0;        //il blocco inizia all'inizio di un byte
+
+    while(covered < raw_size){
+        s = unpackBlock(d, batch, raw_size, history, &covered, &read_bits, buffer, infile);
+        if(s < 0)
+            return NULL;
+
+        //DECOMPRESSIONE
+        PHASE_PUSH(PHASE_COPY);
+        for(long n = 0; n < s; n++){
+            //SE LENGTH != 0 torno indietro di offset e faccio una copia parallela con i 2 puntatori
+            if (d[n].l != 0)
+                d_lookahead = copyMatch(d_lookahead, d[n].o, d[n].l);
+
+            //in ogni caso copio nextchar
+            *d_lookahead = d[n].a;
+            d_lookahead++;
+        }
+        PHASE_POP();
+    }
+
+    if((read_bits + 7) / 8 != packed_size)
+        return NULL;
+    return d_lookahead;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_decompressFile(struct lz77_context *, FILE *, FILE *)
+ *
+ * La funzione di decompressione si occupa di "pilotare" la lettura bufferizzata e di scrivere a blocchi i byte che
+ * che vengono decompressi.
+ *
+ * Dopo il controllo dell'intestazione del file (vedi readStreamHeader) vengono letti i blocchi uno alla volta e
+ * decompressi nell'array decompressed (vedi decodeBlock).
+ *
+ * Per dire al programma quanti bit deve estrapolare dai codici bufferizzati è sufficiente modificare il valore della
+ * variabile globale n_bits (vedi funzione extractCodes)
+ *
+ * Se l'array decompressed non ha più spazio per il prossimo blocco viene reinizializzato (vedi flushDecompressed).
+ * Alla fine di ogni blocco i byte decompressi non ancora scritti vengono scritti su file con la funzione di libreria
+ * fwrite.
+ *
+ * Il processo viene ripetuto fino a quando non vengono letti tutti i blocchi dal file compresso.
+ *
+ * L'array decompressed e l'array delle codifiche sono quelli del contesto (vedi LZ77_newContext), allocati al primo
+ * uso e riutilizzati per i file successivi.
+ *
+ * @param context
+ * @param infile
+ * @param outfile
+ * @return          --> 0 se il file è stato decompresso, 1 se il file compresso non è valido
+ */
+int LZ77_decompressFile(struct lz77_context *context, FILE *infile, FILE *outfile){
+
+    //Variabili
+    int type;
+    int eof=0;
+    size_t raw_size, packed_size;
+    unsigned char *decompressed;    //bytes decompressi
+    struct code *d;                 //array di strutture che contenente le codifiche
+
+    //PUNTATORI
+    unsigned char *last_element;    //fine array bytes decompressi
+    unsigned char *d_lookahead;     //inizio look-ahead buffer
+    unsigned char *written;         //primo byte decompresso non ancora scritto su file
+
+    if(context->decompressed == NULL)
+        context->decompressed = malloc(context->stream_size);
+    if(context->codes == NULL)
+        context->codes = malloc(context->batch * sizeof(struct code));
+    if((decompressed = context->decompressed) == NULL || (d = context->codes) == NULL){
+        printf("!WARNING! Cannot allocate the codes array.\n");
+        return 1;
+    }
+    last_element = &decompressed[context->stream_size-1];
+    d_lookahead = decompressed;
+    written = decompressed;
+
+    if(!readStreamHeader(infile)){
+        printf("!WARNING! Input file is not a LZ77 compressed file (or was compressed with other parameters).\n");
+        return 1;
+    }
+
+    while((type = getNextCode(&infile)) != EOF){
+
+        raw_size = readUint32(infile, &eof);
+        packed_size = readUint32(infile, &eof);
+        if(!eof && type == BLOCK_INDEX){
+            //l'indice (vedi seek.c) non serve per decomprimere tutto il file, ma deve essere l'ultimo blocco
+            while(packed_size > 0 && fgetc(infile) != EOF)
+                packed_size--;
+            if(packed_size == 0)
+                type = getNextCode(&infile);
+            break;
+        }
+        if(eof || raw_size > BLOCK_SIZE || (type == BLOCK_STORED && packed_size != raw_size) ||
+           (type != BLOCK_STORED && type != BLOCK_LZ77))
+            break;
+
+        //Reinizializzazione array decompressed se il prossimo blocco potrebbe non starci
+        if(d_lookahead + raw_size >= last_element)
+            d_lookahead = flushDecompressed(decompressed, d_lookahead, &written, outfile);
+
+        d_lookahead = decodeBlock(type, raw_size, packed_size, d, context->batch, decompressed, d_lookahead, infile);
+        if(d_lookahead == NULL)
+            break;
+
+        //scrittura blocco di byte decompressi
+        writeBytes(written, d_lookahead-written, outfile);
+        written = d_lookahead;
+    }
+
+    if(type != EOF){
+        printf("!WARNING! Compressed file is truncated or corrupted.\n");
+        return 1;
+    }
+    return 0;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_decompressor(FILE *, FILE *)
+ *
+ * Decompressione di un solo file con un contesto temporaneo (vedi LZ77_decompressFile).
+ *
+ * @param infile
+ * @param outfile
+ * @return          --> 0 se il file è stato decompresso, 1 se il file compresso non è valido
+ */
+int LZ77_decompressor(FILE *infile, FILE *outfile){
+    struct lz77_context *context = LZ77_newContext();
+    int error;
+
+    if(context == NULL){
+        printf("!WARNING! Cannot allocate the codes array.\n");
+        return 1;
+    }
+    error = LZ77_decompressFile(context, infile, outfile);
+    LZ77_freeContext(context);
+    return error;
+}
+
+
+
+
+
+
+
+
+
+
+
+/***********************************************************************************************************************
+                                                   CODEC IN MEMORIA
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * size_t LZ77_bound(size_t)
+ *
+ * Grandezza massima di un buffer compresso da LZ77_compressBuffer: nel caso peggiore ogni blocco viene memorizzato
+ * così com'è, con la sua intestazione.
+ *
+ * @param raw_size
+ * @return
+ */
+size_t LZ77_bound(size_t raw_size){
+    return raw_size + BLOCK_HEADER_SIZE * ((raw_size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+}
+
+/***********************************************************************************************************************
+ * size_t LZ77_compressBuffer(unsigned char [], size_t, unsigned char [], size_t)
+ *
+ * Compressione di un buffer in memoria per il codec LZ77 (vedi common/lz_codec.h): il buffer viene diviso in blocchi
+ * di BLOCK_SIZE byte come da LZ77_compressor, ma senza intestazione del file (i parametri del codec sono
+ * l'intestazione scritta da writeStreamHeader). La finestra non va oltre l'inizio del
+ * buffer, quindi il buffer compresso si decomprime da solo.
+ *
+ * @param raw
+ * @param raw_size
+ * @param packed
+ * @param capacity  --> byte disponibili in packed
+ * @return          --> byte compressi, 0 se non stanno in capacity byte
+ */
+size_t LZ77_compressBuffer(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity){
+    char *bytes = NULL;             //blocchi compressi
+    size_t bytes_size = 0;
+    size_t position = 0, size, result = 0;
+    FILE *stream = open_memstream(&bytes, &bytes_size);
+
+    if(stream == NULL)
+        return 0;
+    while(position < raw_size){
+        size = raw_size - position < BLOCK_SIZE ? raw_size - position : BLOCK_SIZE;
+        LZ77_compressBlock(raw + position, size, position < WINDOW ? position : WINDOW, stream);
+        position += size;
+    }
+    fclose(stream);
+
+    if(bytes_size <= capacity){
+        memcpy(packed, bytes, bytes_size);
+        result = bytes_size;
+    }
+    free(bytes);
+    return result;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_decompressBuffer(unsigned char [], size_t, unsigned char [], size_t)
+ *
+ * Decompressione di un buffer compresso da LZ77_compressBuffer: i blocchi vengono decompressi direttamente in raw
+ * (vedi decodeBlock), che deve essere riempito esattamente.
+ *
+ * @param packed
+ * @param packed_size
+ * @param raw
+ * @param raw_size
+ * @return          --> 0 se il buffer è stato decompresso, 1 se non è valido
+ */
+int LZ77_decompressBuffer(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size){
+    FILE *infile = fmemopen(packed, packed_size, "rb");
+    struct code *d = malloc(BLOCK_SIZE * sizeof(struct code));
+    unsigned char *d_lookahead = raw;
+    unsigned char *end = raw + raw_size;
+    size_t block_raw, block_packed;
+    int type, eof=0, error=1;
+
+    if(infile != NULL && d != NULL){
+        while(d_lookahead < end && (type = getNextCode(&infile)) != EOF){
+            block_raw = readUint32(infile, &eof);
+            block_packed = readUint32(infile, &eof);
+            if(eof || block_raw > BLOCK_SIZE || block_raw > (size_t) (end - d_lookahead) ||
+               (type == BLOCK_STORED && block_packed != block_raw) || (type != BLOCK_STORED && type != BLOCK_LZ77))
+                break;
+            d_lookahead = decodeBlock(type, block_raw, block_packed, d, BLOCK_SIZE, raw, d_lookahead, infile);
+            if(d_lookahead == NULL)
+                break;
+        }
+        error = d_lookahead != end || getNextCode(&infile) != EOF;
+    }
+
+    if(infile != NULL)
+        fclose(infile);
+    free(d);
+    return error;
+}
+
+const LZCodec lz77_codec = { CODEC_LZ77, "lz77", LZ77_bound, LZ77_compressBuffer, LZ77_decompressBuffer,
+                             writeStreamHeader, readStreamHeader };
@@ -0,0 +1,157 @@
+/***********************************************************************************************************************
+ *
+ *  lz77.h
+ *
+ *  Autore: Ivan Pavic
+ *
+ ***********************************************************************************************************************
+ *
+ *  Definizioni, strutture e funzioni dell'algoritmo di compressione LZ77 (vedi lz77.c).
+ *  Il programma da riga di comando si trova in main.c, i microbenchmark delle singole funzioni in bench/.
+ *  Il codec lz77_codec (vedi common/lz_codec.h) è usato dal programma LZ (vedi LZ/lz.c).
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ77_H
+#define LZ77_H
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <stdio.h>
+#include "../common/lz_timing.h"
+#include "../common/lz_stats.h"
+#include "../common/lz_codec.h"
+#include "../common/lz_pipeline.h"
+
+/*******************************************************DEFINE*********************************************************/
+
+#define LOOKAHEAD 8
+#define WINDOW 8192
+#define STREAM_SIZE 4000000
+#define BUFFER_SIZE 8
+#define STRUCT_ARRAY_SIZE 600000
+
+//Memoria limitata (vedi LZ77_newContext)
+#define MIN_STREAM_SIZE (2 * (WINDOW + BLOCK_SIZE))     //buffer più piccolo dei byte letti e decompressi
+#define MIN_BATCH 256                   //codifiche debufferizzate alla volta con il limite più piccolo
+
+//Formato del file compresso (vedi lz77.c)
+#define LZ77_MAGIC "LZ77"
+#define LZ77_VERSION 1
+#define STREAM_HEADER_SIZE 7
+#define BLOCK_SIZE 65536                //byte originali per blocco
+#define BLOCK_HEADER_SIZE 9             //tipo (1 byte), byte originali (4 byte), byte del blocco (4 byte)
+#define BLOCK_STORED 0                  //blocco memorizzato così com'è
+#define BLOCK_LZ77 1                    //blocco di codifiche LZ77
+#define BLOCK_INDEX 2                   //indice dei blocchi, ultimo blocco dei file con accesso casuale (vedi seek.c)
+#define INDEX_MAGIC "LZ7I"
+#define INDEX_ENTRY_SIZE 16             //byte originali precedenti (8 byte), posizione nel file compresso (8 byte)
+#define INDEX_TRAILER_SIZE 12           //posizione del blocco indice (8 byte), INDEX_MAGIC
+
+#define ENTROPY_THRESHOLD 7.0           //bit per byte oltre i quali viene stimato il costo della compressione
+#define MATCH_SAMPLES 32                //ricerche fatte per la stima del costo della compressione
+
+/*****************************************************STRUTTURE********************************************************/
+
+struct code
+{
+    int o;		        //offset
+    int l;		        //length
+    unsigned char a;	//next char
+};
+
+//Statistiche sulle codifiche generate dal compressore (solo con -DLZ_STATS=1, vedi common/lz_stats.h)
+struct lz77_stats
+{
+    unsigned long long bytes;                               //byte codificati
+    unsigned long long tokens;                              //codifiche generate
+    unsigned long long literals;                            //codifiche con lunghezza 0
+    unsigned long long searches;                            //ricerche nella finestra (una per codifica)
+    unsigned long long probes;                              //posizioni della finestra confrontate
+    unsigned long long length_hist[LOOKAHEAD];              //istogramma delle lunghezze
+    unsigned long long offset_hist[STATS_LOG2_BUCKETS];     //istogramma logaritmico degli offset
+    unsigned long long probes_hist[STATS_LOG2_BUCKETS];     //istogramma logaritmico dei confronti per ricerca
+    unsigned long long blocks;                              //blocchi scritti
+    unsigned long long stored_blocks;                       //blocchi memorizzati così come sono (BLOCK_STORED)
+    unsigned long long stored_bytes;                        //byte dei blocchi memorizzati
+};
+
+//Buffer della compressione e della decompressione di un file, riutilizzati per i file successivi (uno per ogni thread)
+struct lz77_context
+{
+    unsigned char *input;                                   //byte letti dal file da comprimere (stream_size byte)
+    unsigned char *decompressed;                            //byte decompressi (stream_size byte)
+    struct code *codes;                                     //codifiche debufferizzate (batch elementi)
+    size_t stream_size;                                     //STREAM_SIZE, meno con il limite di memoria
+    size_t batch;                                           //BLOCK_SIZE, meno con il limite di memoria
+};
+
+/**************************************************VARIABILI GLOBALI***************************************************/
+
+extern size_t context_memory;                       //memoria di un contesto, 0 = senza limite (vedi LZ77_newContext)
+
+//una copia per ogni thread (modalità batch, vedi main.c)
+extern LZ_THREAD_LOCAL int bits;
+extern LZ_THREAD_LOCAL int decimal;
+extern LZ_THREAD_LOCAL int counter;
+extern LZ_THREAD_LOCAL int n_bits;                  //vedi la funzione extractCodes
+extern LZ_THREAD_LOCAL int buffer_position;         //vedi la funzione extractCodes
+#if LZ_STATS
+extern LZ_THREAD_LOCAL struct lz77_stats lz77_stats;    //vedi struct lz77_stats
+#endif
+
+/******************************************************CONTESTO********************************************************/
+
+struct lz77_context *LZ77_newContext();
+void LZ77_freeContext(struct lz77_context *context);
+
+/*****************************************************COMPRESSIONE*****************************************************/
+
+void inizializeCharArray(unsigned char array[], int size);
+void inizializeArray(int array [], int size);
+size_t readBytes(unsigned char *bytes, size_t size, FILE *infile);
+void writeBytes(const unsigned char *bytes, size_t size, FILE *outfile);
+int binToDec(int buffer[]);
+void fillBuffer(int buffer[], int bit, FILE *outfile);
+void decToBin(int buffer[], int n, int b_size, FILE  *outfile);
+int bufferizedWriting(struct code *code, int *buffer, FILE *outfile);
+void flushBits(int buffer[], FILE *outfile);
+void writeUint32(unsigned long value, FILE *outfile);
+unsigned long readUint32(FILE *infile, int *eof);
+void writeUint64(unsigned long long value, FILE *outfile);
+unsigned long long readUint64(FILE *infile, int *eof);
+void writeStreamHeader(FILE *outfile);
+int findLongestMatch(unsigned char *lookahead, unsigned char *window, unsigned char *endOfBuffer, struct code *match);
+double blockEntropy(const unsigned char *block, size_t size);
+double sampleMatchCost(unsigned char *block, size_t size, size_t history);
+void encodeBlock(unsigned char *block, size_t size, size_t history, FILE *outfile);
+int LZ77_compressBlock(unsigned char *block, size_t size, size_t history, FILE *outfile);
+int LZ77_compressFile(struct lz77_context *context, FILE *infile, FILE *outfile);
+int LZ77_compressor(FILE *infile, FILE *outfile);
+
+/****************************************************DECOMPRESSIONE****************************************************/
+
+void initializeCharArray(unsigned char *array, int size);
+void initializeIntArray(int *array, int size);
+void fillBuffer_d(int buffer[], int bit);
+int getNextCode(FILE **infile);
+void decToBin_d(int buffer[], int n, int b_size);
+int extractCodes(int buffer[], FILE *infile);
+unsigned char *copyMatch(unsigned char *d_lookahead, int offset, int length);
+unsigned char *flushDecompressed(unsigned char *decompressed, unsigned char *d_lookahead, unsigned char **written,
+                                 FILE *outfile);
+int readStreamHeader(FILE *infile);
+long unpackBlock(struct code d[], size_t batch, size_t raw_size, size_t history, size_t *covered, size_t *read_bits,
+                 int buffer[], FILE *infile);
+unsigned char *decodeBlock(int type, size_t raw_size, size_t packed_size, struct code d[], size_t batch,
+                           unsigned char *start, unsigned char *d_lookahead, FILE *infile);
+int LZ77_decompressFile(struct lz77_context *context, FILE *infile, FILE *outfile);
+int LZ77_decompressor(FILE *infile, FILE *outfile);
+
+/**************************************************CODEC IN MEMORIA****************************************************/
+
+size_t LZ77_bound(size_t raw_size);
+size_t LZ77_compressBuffer(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity);
+int LZ77_decompressBuffer(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size);
+
+#endif
@@ -0,0 +1,325 @@
+/***********************************************************************************************************************
+ *
+ *  reader.c
+ *
+ *  Lettura ad accesso casuale dei file compressi con LZ77_compressSeekable (vedi seek.c).
+ *
+ ***********************************************************************************************************************
+ *                                              CACHE DEI BLOCCHI DECOMPRESSI                                          *
+ ***********************************************************************************************************************
+ *
+ * LZ77_readAt legge un intervallo di byte originali di un file compresso con l'indice (vedi LZ77_readIndex)
+ * decomprimendo solo i blocchi che coprono l'intervallo. Le letture ripetute delle stesse zone del file
+ * decomprimerebbero ogni volta gli stessi blocchi, quindi i blocchi decompressi restano in una cache:
+ *
+ * - la chiave di un blocco è la coppia (file, blocco): ogni file aperto con LZ77_openReader riceve un numero
+ *   diverso, quindi la stessa cache può essere usata per più file;
+ * - i blocchi sono in una tabella hash (ricerca) e in una lista ordinata dall'ultimo uso (LRU): ogni lettura porta il
+ *   blocco in testa alla lista, quando la memoria dei blocchi supera il limite vengono tolti i blocchi in fondo, cioè
+ *   quelli non usati da più tempo;
+ * - il limite di memoria conta i byte decompressi e la struttura di ogni blocco; con un limite più piccolo di un
+ *   blocco la cache resta vuota e ogni lettura decomprime il blocco;
+ * - i contatori (letture dalla cache, blocchi decompressi, blocchi tolti) sono restituiti da LZ77_cacheStats.
+ *
+ * La cache è protetta da un mutex e può essere condivisa da più thread, ognuno con i suoi lettori: i byte vengono
+ * copiati dalla cache con il mutex preso, la decompressione di un blocco mancante avviene senza mutex nel buffer del
+ * lettore e il blocco viene poi copiato nella cache.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "reader.h"
+
+/***********************************************************************************************************************
+*                                                        CACHE                                                         *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * struct lz77_cache *LZ77_newCache(size_t)
+ * void LZ77_freeCache(struct lz77_cache *)
+ *
+ * Creazione e distruzione di una cache con al massimo budget byte di memoria per i blocchi. La tabella hash ha circa
+ * due liste per ogni blocco che può stare nella cache. I lettori della cache vanno chiusi prima della cache.
+ *
+ * @param budget
+ * @return          --> cache vuota, NULL se la memoria non è sufficiente
+ */
+struct lz77_cache *LZ77_newCache(size_t budget){
+    struct lz77_cache *cache = calloc(1, sizeof(struct lz77_cache));
+    size_t blocks = budget / BLOCK_SIZE;
+
+    if(cache == NULL)
+        return NULL;
+    cache->budget = budget;
+    cache->buckets = 16;
+    while(cache->buckets < 2 * blocks && cache->buckets < (1u << 20))
+        cache->buckets *= 2;
+    if((cache->table = calloc(cache->buckets, sizeof(struct cache_entry *))) == NULL){
+        free(cache);
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+void LZ77_freeCache(struct lz77_cache *cache){
+    struct cache_entry *entry, *older;
+
+    if(cache == NULL)
+        return;
+    for(entry = cache->newest; entry != NULL; entry = older){
+        older = entry->older;
+        free(entry);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->table);
+    free(cache);
+}
+
+/***********************************************************************************************************************
+ * void LZ77_cacheStats(struct lz77_cache *, struct lz77_cache_stats *)
+ *
+ * Copia dei contatori della cache.
+ */
+void LZ77_cacheStats(struct lz77_cache *cache, struct lz77_cache_stats *stats){
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/***********************************************************************************************************************
+ * struct cache_entry **findEntry(struct lz77_cache *, int, int)
+ *
+ * Ricerca di un blocco nella tabella hash (con il mutex preso).
+ *
+ * @return  --> puntatore al collegamento che punta al blocco (per toglierlo dalla lista), al collegamento NULL in
+ *              fondo alla lista se il blocco non c'è
+ */
+static struct cache_entry **findEntry(struct lz77_cache *cache, int file, int block){
+    unsigned hash = ((unsigned) file * 0x9E3779B1u) ^ ((unsigned) block * 0x85EBCA77u);
+    struct cache_entry **link = &cache->table[(hash ^ (hash >> 16)) & (cache->buckets - 1)];
+
+    while(*link != NULL && ((*link)->file != file || (*link)->block != block))
+        link = &(*link)->chain;
+    return link;
+}
+
+/***********************************************************************************************************************
+ * void unlinkEntry(struct lz77_cache *, struct cache_entry *)
+ * void pushNewest(struct lz77_cache *, struct cache_entry *)
+ *
+ * Spostamenti nella lista LRU (con il mutex preso): il blocco viene tolto dalla lista o messo in testa.
+ */
+static void unlinkEntry(struct lz77_cache *cache, struct cache_entry *entry){
+    if(entry->newer != NULL)
+        entry->newer->older = entry->older;
+    else
+        cache->newest = entry->older;
+    if(entry->older != NULL)
+        entry->older->newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+}
+
+static void pushNewest(struct lz77_cache *cache, struct cache_entry *entry){
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if(cache->newest != NULL)
+        cache->newest->newer = entry;
+    else
+        cache->oldest = entry;
+    cache->newest = entry;
+}
+
+/***********************************************************************************************************************
+ * void dropEntry(struct lz77_cache *, struct cache_entry *)
+ *
+ * Rimozione di un blocco dalla cache (con il mutex preso).
+ */
+static void dropEntry(struct lz77_cache *cache, struct cache_entry *entry){
+    struct cache_entry **link = findEntry(cache, entry->file, entry->block);
+
+    *link = entry->chain;
+    unlinkEntry(cache, entry);
+    cache->stats.entries--;
+    cache->stats.bytes -= sizeof(struct cache_entry) + entry->size;
+    free(entry);
+}
+
+/***********************************************************************************************************************
+ * int cacheCopy(struct lz77_cache *, int, int, size_t, size_t, unsigned char [])
+ *
+ * Copia di length byte del blocco a partire dal byte from, se il blocco è nella cache; il blocco diventa il più
+ * recente.
+ *
+ * @return  --> 1 se il blocco è nella cache, 0 altrimenti
+ */
+static int cacheCopy(struct lz77_cache *cache, int file, int block, size_t from, size_t length,
+                     unsigned char buffer[]){
+    struct cache_entry *entry;
+
+    pthread_mutex_lock(&cache->lock);
+    if((entry = *findEntry(cache, file, block)) != NULL){
+        cache->stats.hits++;
+        memcpy(buffer, entry->bytes + from, length);
+        unlinkEntry(cache, entry);
+        pushNewest(cache, entry);
+    } else {
+        cache->stats.misses++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return entry != NULL;
+}
+
+/***********************************************************************************************************************
+ * void cacheInsert(struct lz77_cache *, int, int, const unsigned char [], size_t)
+ *
+ * Inserimento di un blocco appena decompresso: i blocchi meno recenti vengono tolti fino a quando il nuovo blocco
+ * non sta nel limite di memoria. Se il blocco è già stato inserito da un altro thread o non sta nemmeno nella
+ * cache vuota, la cache non cambia.
+ */
+static void cacheInsert(struct lz77_cache *cache, int file, int block, const unsigned char bytes[], size_t size){
+    size_t cost = sizeof(struct cache_entry) + size;
+    struct cache_entry **link, *entry;
+
+    if(cost > cache->budget || (entry = malloc(cost)) == NULL)
+        return;
+    entry->file = file;
+    entry->block = block;
+    entry->size = size;
+    entry->chain = NULL;
+    memcpy(entry->bytes, bytes, size);
+
+    pthread_mutex_lock(&cache->lock);
+    if(*(link = findEntry(cache, file, block)) != NULL){
+        pthread_mutex_unlock(&cache->lock);
+        free(entry);
+        return;
+    }
+    while(cache->stats.bytes + cost > cache->budget){
+        dropEntry(cache, cache->oldest);
+        cache->stats.evictions++;
+    }
+    *findEntry(cache, file, block) = entry;        //la lista della tabella può essere cambiata togliendo i blocchi
+    pushNewest(cache, entry);
+    cache->stats.entries++;
+    cache->stats.bytes += cost;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+
+
+
+
+
+
+
+
+
+/***********************************************************************************************************************
+*                                                       LETTORE                                                        *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * struct lz77_reader *LZ77_openReader(struct lz77_cache *, FILE *, int *)
+ * void LZ77_closeReader(struct lz77_reader *)
+ *
+ * Apertura di un file compresso con LZ77_compressSeekable per la lettura ad accesso casuale (il file resta del
+ * chiamante e deve permettere fseeko). Alla chiusura i blocchi del file vengono tolti dalla cache; un lettore non
+ * aperto non ha ancora una chiave (file = -1) e non tocca i blocchi degli altri file.
+ *
+ * @param cache
+ * @param infile
+ * @param invalid   --> 1 se il file non ha l'indice (vedi LZ77_readIndex), 0 se la memoria non è sufficiente
+ * @return          --> lettore, NULL se il file non ha l'indice o la memoria non è sufficiente
+ */
+struct lz77_reader *LZ77_openReader(struct lz77_cache *cache, FILE *infile, int *invalid){
+    struct lz77_reader *reader = calloc(1, sizeof(struct lz77_reader));
+
+    *invalid = 0;
+    if(reader == NULL)
+        return NULL;
+    reader->cache = cache;
+    reader->file = -1;
+    reader->infile = infile;
+    reader->context = LZ77_newContext();
+    reader->block = malloc(BLOCK_SIZE);
+    if(reader->context != NULL && reader->block != NULL)
+        *invalid = (reader->index = LZ77_readIndex(infile)) == NULL;
+    if(reader->index == NULL){
+        LZ77_closeReader(reader);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    reader->file = cache->files++;
+    pthread_mutex_unlock(&cache->lock);
+    return reader;
+}
+
+void LZ77_closeReader(struct lz77_reader *reader){
+    struct cache_entry *entry, *older;
+
+    if(reader == NULL)
+        return;
+    if(reader->file >= 0){
+        pthread_mutex_lock(&reader->cache->lock);
+        for(entry = reader->cache->newest; entry != NULL; entry = older){
+            older = entry->older;
+            if(entry->file == reader->file)
+                dropEntry(reader->cache, entry);
+        }
+        pthread_mutex_unlock(&reader->cache->lock);
+    }
+    LZ77_freeIndex(reader->index);
+    LZ77_freeContext(reader->context);
+    free(reader->block);
+    free(reader);
+}
+
+/***********************************************************************************************************************
+ * long long LZ77_readerSize(const struct lz77_reader *)
+ *
+ * @return  --> byte del file originale
+ */
+long long LZ77_readerSize(const struct lz77_reader *reader){
+    return reader->index->raw_offset[reader->index->blocks];
+}
+
+/***********************************************************************************************************************
+ * long long LZ77_readAt(struct lz77_reader *, unsigned char [], long long, long long)
+ *
+ * Lettura di length byte originali a partire da offset (l'intervallo viene limitato alla fine del file): per ogni
+ * blocco dell'intervallo i byte vengono copiati dalla cache oppure il blocco viene decompresso (vedi LZ77_readBlock)
+ * e inserito nella cache.
+ *
+ * @param reader
+ * @param buffer    --> almeno length byte
+ * @param length
+ * @param offset
+ * @return          --> byte letti, -1 se un blocco è troncato o non valido
+ */
+long long LZ77_readAt(struct lz77_reader *reader, unsigned char buffer[], long long length, long long offset){
+    const struct lz77_index *index = reader->index;
+    long long copied = 0, from, count;
+    long size;
+    int block;
+
+    while(copied < length && (block = LZ77_findBlock(index, offset)) >= 0){
+        from = offset - index->raw_offset[block];
+        count = index->raw_offset[block + 1] - offset;
+        if(count > length - copied)
+            count = length - copied;
+
+        if(!cacheCopy(reader->cache, reader->file, block, (size_t) from, (size_t) count, buffer + copied)){
+            if((size = LZ77_readBlock(reader->context, reader->infile, index, block, reader->block)) < 0)
+                return -1;
+            memcpy(buffer + copied, reader->block + from, (size_t) count);
+            cacheInsert(reader->cache, reader->file, block, reader->block, (size_t) size);
+        }
+        copied += count;
+        offset += count;
+    }
+    return copied;
+}
@@ -0,0 +1,78 @@
+/***********************************************************************************************************************
+ *
+ *  reader.h
+ *
+ *  Lettura ad accesso casuale dei file compressi con LZ77_compressSeekable, con una cache LRU dei blocchi
+ *  decompressi (vedi reader.c).
+ *
+ **********************************************************************************************************************/
+
+#ifndef READER_H
+#define READER_H
+
+/*******************************************************INCLUDE********************************************************/
+
+#include <pthread.h>
+#include "seek.h"
+
+/*******************************************************DEFINE*********************************************************/
+
+#define READER_CACHE_SIZE 16777216      //memoria della cache usata da ./main -d --range (16 MB, 256 blocchi)
+
+/*****************************************************STRUTTURE********************************************************/
+
+//Blocco decompresso nella cache: chiave (file, blocco), posizione nella lista LRU e nella tabella hash
+struct cache_entry
+{
+    int file;
+    int block;
+    size_t size;                    //byte del blocco
+    struct cache_entry *newer, *older;      //lista LRU (il più recente in testa)
+    struct cache_entry *chain;              //blocchi con lo stesso hash
+    unsigned char bytes[];
+};
+
+//Contatori della cache
+struct lz77_cache_stats
+{
+    unsigned long long hits;        //letture servite dalla cache
+    unsigned long long misses;      //letture che hanno decompresso il blocco
+    unsigned long long evictions;   //blocchi tolti dalla cache per rispettare il limite di memoria
+    unsigned long long entries;     //blocchi nella cache
+    unsigned long long bytes;       //memoria usata dai blocchi nella cache
+};
+
+//Cache LRU dei blocchi decompressi, condivisa da più file e da più thread
+struct lz77_cache
+{
+    pthread_mutex_t lock;
+    size_t budget;                  //memoria massima dei blocchi (byte decompressi più la struttura di ogni blocco)
+    struct cache_entry **table;     //tabella hash: buckets liste di blocchi (vedi chain)
+    unsigned buckets;               //potenza di 2
+    struct cache_entry *newest, *oldest;
+    int files;                      //file aperti finora (chiave del prossimo file)
+    struct lz77_cache_stats stats;
+};
+
+//File compresso aperto per la lettura ad accesso casuale (da usare su un solo thread)
+struct lz77_reader
+{
+    struct lz77_cache *cache;
+    int file;                       //chiave del file nella cache, -1 finché il lettore non è aperto
+    FILE *infile;
+    struct lz77_index *index;
+    struct lz77_context *context;   //codifiche della decompressione
+    unsigned char *block;           //blocco decompresso (BLOCK_SIZE byte)
+};
+
+/******************************************************FUNZIONI********************************************************/
+
+struct lz77_cache *LZ77_newCache(size_t budget);
+void LZ77_freeCache(struct lz77_cache *cache);
+void LZ77_cacheStats(struct lz77_cache *cache, struct lz77_cache_stats *stats);
+struct lz77_reader *LZ77_openReader(struct lz77_cache *cache, FILE *infile, int *invalid);
+void LZ77_closeReader(struct lz77_reader *reader);
+long long LZ77_readerSize(const struct lz77_reader *reader);
+long long LZ77_readAt(struct lz77_reader *reader, unsigned char buffer[], long long length, long long offset);
+
+#endif
@@ -0,0 +1,293 @@
+/***********************************************************************************************************************
+ *
+ *  seek.c
+ *
+ *  Compressione con accesso casuale e decompressione di un singolo blocco.
+ *
+ ***********************************************************************************************************************
+ *                                                 ACCESSO CASUALE                                                     *
+ ***********************************************************************************************************************
+ *
+ * Nei file compressi normali la finestra di ogni blocco comprende i byte dei blocchi precedenti, quindi per leggere
+ * pochi byte in mezzo al file bisogna decomprimere tutto il file fino a quel punto.
+ *
+ * I file compressi con LZ77_compressSeekable hanno lo stesso formato (vedi lz77.c) con due differenze:
+ *
+ * 1. ogni blocco è compresso senza i byte dei blocchi precedenti (come da LZ77_compressBuffer), quindi si decomprime
+ *    da solo; con una finestra di WINDOW byte e blocchi di BLOCK_SIZE byte si perdono solo le sequenze dei primi
+ *    WINDOW byte di ogni blocco;
+ * 2. l'ultimo blocco è l'indice (BLOCK_INDEX), con una voce per ogni blocco più una finale:
+ *
+ *      +-------+-------------+---------------+--------------------------+---------------------+----------------+
+ *      | tipo  | voci (4)    | byte (4)      | voci: byte originali (8) | posizione indice (8)| INDEX_MAGIC (4)|
+ *      |       |             |               |       posizione (8)      |                     |                |
+ *      +-------+-------------+---------------+--------------------------+---------------------+----------------+
+ *
+ *    gli ultimi INDEX_TRAILER_SIZE byte del file permettono di trovare l'indice partendo dalla fine.
+ *
+ * Il decompressore normale salta l'indice, quindi i file con accesso casuale si decomprimono anche per intero.
+ * LZ77_readIndex legge l'indice, LZ77_findBlock cerca il blocco di un byte (ricerca binaria) e LZ77_readBlock
+ * decomprime un solo blocco: la lettura di un intervallo (LZ77_readAt in reader.c) decomprime solo i blocchi che lo
+ * coprono.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************INCLUDE********************************************************/
+
+#define _POSIX_C_SOURCE 200809L     //fseeko, ftello
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "seek.h"
+
+/***********************************************************************************************************************
+*                                                       FUNZIONI                                                       *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * struct lz77_index *newIndex(int)
+ *
+ * Indice vuoto con spazio per blocks + 1 voci.
+ *
+ * @param blocks
+ * @return          --> indice, NULL se la memoria non è sufficiente
+ */
+static struct lz77_index *newIndex(int blocks){
+    struct lz77_index *index = calloc(1, sizeof(struct lz77_index));
+
+    if(index == NULL)
+        return NULL;
+    index->blocks = blocks;
+    index->raw_offset = malloc(((size_t) blocks + 1) * sizeof(long long));
+    index->packed_offset = malloc(((size_t) blocks + 1) * sizeof(long long));
+    if(index->raw_offset == NULL || index->packed_offset == NULL){
+        LZ77_freeIndex(index);
+        return NULL;
+    }
+    return index;
+}
+
+void LZ77_freeIndex(struct lz77_index *index){
+    if(index == NULL)
+        return;
+    free(index->raw_offset);
+    free(index->packed_offset);
+    free(index);
+}
+
+/***********************************************************************************************************************
+ * int addEntry(struct lz77_index *, int *, long long, long long)
+ *
+ * Aggiunta della voce di un nuovo blocco durante la compressione (la capacità viene raddoppiata quando serve).
+ *
+ * @return  --> 1, 0 se la memoria non è sufficiente
+ */
+static int addEntry(struct lz77_index *index, int *capacity, long long raw_offset, long long packed_offset){
+    long long *raw, *packed;
+
+    if(index->blocks == *capacity){
+        raw = realloc(index->raw_offset, ((size_t) *capacity * 2 + 64) * sizeof(long long));
+        if(raw != NULL)
+            index->raw_offset = raw;
+        packed = realloc(index->packed_offset, ((size_t) *capacity * 2 + 64) * sizeof(long long));
+        if(packed != NULL)
+            index->packed_offset = packed;
+        if(raw == NULL || packed == NULL)
+            return 0;
+        *capacity = *capacity * 2 + 64;
+    }
+    index->raw_offset[index->blocks] = raw_offset;
+    index->packed_offset[index->blocks] = packed_offset;
+    index->blocks++;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * void writeIndex(const struct lz77_index *, FILE *)
+ *
+ * Scrittura del blocco indice (vedi l'inizio del file): tutte le voci, compresa quella finale, e la posizione del
+ * blocco indice, che è la posizione della voce finale.
+ */
+static void writeIndex(const struct lz77_index *index, FILE *outfile){
+    fputc(BLOCK_INDEX, outfile);
+    writeUint32((unsigned long) index->blocks + 1, outfile);
+    writeUint32(((unsigned long) index->blocks + 1) * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE, outfile);
+    for(int i=0; i<=index->blocks; i++){
+        writeUint64((unsigned long long) index->raw_offset[i], outfile);
+        writeUint64((unsigned long long) index->packed_offset[i], outfile);
+    }
+    writeUint64((unsigned long long) index->packed_offset[index->blocks], outfile);
+    writeBytes((const unsigned char *) INDEX_MAGIC, 4, outfile);
+}
+
+/***********************************************************************************************************************
+ * int LZ77_compressSeekable(FILE *, FILE *)
+ *
+ * Compressione con accesso casuale: il file viene letto e compresso un blocco alla volta, ogni blocco senza i byte
+ * dei blocchi precedenti (vedi LZ77_compressBuffer); alla fine viene scritto l'indice dei blocchi.
+ *
+ * @param infile
+ * @param outfile
+ * @return          --> 1 se il file è stato compresso, 0 se la memoria non è sufficiente
+ */
+int LZ77_compressSeekable(FILE *infile, FILE *outfile){
+    unsigned char *raw = malloc(BLOCK_SIZE);
+    unsigned char *packed = malloc(LZ77_bound(BLOCK_SIZE));
+    struct lz77_index *index = newIndex(0);
+    long long raw_offset = 0, packed_offset = STREAM_HEADER_SIZE;
+    size_t size, packed_size;
+    int capacity = 0, ok = raw != NULL && packed != NULL && index != NULL;
+
+    if(ok)
+        writeStreamHeader(outfile);
+    else
+        printf("!WARNING! Cannot allocate the block buffers.\n");
+    while(ok && (size = readBytes(raw, BLOCK_SIZE, infile)) > 0){
+        if((packed_size = LZ77_compressBuffer(raw, size, packed, LZ77_bound(BLOCK_SIZE))) == 0){
+            printf("!WARNING! Cannot compress block %d (not enough memory).\n", index->blocks);
+            ok = 0;
+        } else if(!addEntry(index, &capacity, raw_offset, packed_offset)){
+            printf("!WARNING! Cannot allocate the block index.\n");
+            ok = 0;
+        } else {
+            writeBytes(packed, packed_size, outfile);
+            raw_offset += (long long) size;
+            packed_offset += (long long) packed_size;
+        }
+    }
+
+    //voce finale: grandezza del file originale e posizione del blocco indice
+    if(ok && addEntry(index, &capacity, raw_offset, packed_offset)){
+        index->blocks--;
+        writeIndex(index, outfile);
+    } else if(ok){
+        printf("!WARNING! Cannot allocate the block index.\n");
+        ok = 0;
+    }
+
+    free(raw);
+    free(packed);
+    LZ77_freeIndex(index);
+    return ok;
+}
+
+/***********************************************************************************************************************
+ * struct lz77_index *LZ77_readIndex(FILE *)
+ *
+ * Lettura dell'indice di un file compresso con accesso casuale (il file deve permettere fseeko). Oltre
+ * all'intestazione del file vengono controllate tutte le voci: i blocchi devono essere consecutivi, con al massimo
+ * BLOCK_SIZE byte originali, e l'ultima voce deve indicare il blocco indice.
+ *
+ * @param infile
+ * @return          --> indice, NULL se il file non ha l'indice o l'indice non è valido
+ */
+struct lz77_index *LZ77_readIndex(FILE *infile){
+    struct lz77_index *index;
+    unsigned char magic[4];
+    unsigned long entries, payload;
+    long long position, end, raw_size, packed_size;
+    int eof = 0;
+
+    if(fseeko(infile, 0, SEEK_SET) != 0 || !readStreamHeader(infile) || fseeko(infile, 0, SEEK_END) != 0)
+        return NULL;
+    end = (long long) ftello(infile);
+    if(end < STREAM_HEADER_SIZE + BLOCK_HEADER_SIZE + INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE ||
+       fseeko(infile, (off_t) (end - INDEX_TRAILER_SIZE), SEEK_SET) != 0)
+        return NULL;
+
+    //posizione del blocco indice e INDEX_MAGIC
+    position = (long long) readUint64(infile, &eof);
+    if(eof || readBytes(magic, 4, infile) != 4 || memcmp(magic, INDEX_MAGIC, 4) != 0 ||
+       position < STREAM_HEADER_SIZE || position >= end || fseeko(infile, (off_t) position, SEEK_SET) != 0 ||
+       getNextCode(&infile) != BLOCK_INDEX)
+        return NULL;
+    entries = readUint32(infile, &eof);
+    payload = readUint32(infile, &eof);
+    if(eof || entries == 0 || entries > (unsigned long) (end / INDEX_ENTRY_SIZE) ||
+       payload != entries * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE ||
+       position + BLOCK_HEADER_SIZE + (long long) payload != end)
+        return NULL;
+
+    if((index = newIndex((int) entries - 1)) == NULL)
+        return NULL;
+    for(unsigned long i=0; i<entries; i++){
+        index->raw_offset[i] = (long long) readUint64(infile, &eof);
+        index->packed_offset[i] = (long long) readUint64(infile, &eof);
+    }
+
+    eof = eof || index->raw_offset[0] != 0 || index->packed_offset[0] != STREAM_HEADER_SIZE ||
+          index->packed_offset[index->blocks] != position;
+    for(int b=0; !eof && b<index->blocks; b++){
+        raw_size = index->raw_offset[b + 1] - index->raw_offset[b];
+        packed_size = index->packed_offset[b + 1] - index->packed_offset[b];
+        eof = raw_size <= 0 || raw_size > BLOCK_SIZE || packed_size <= BLOCK_HEADER_SIZE ||
+              packed_size > BLOCK_HEADER_SIZE + raw_size;
+    }
+    if(eof){
+        LZ77_freeIndex(index);
+        return NULL;
+    }
+    return index;
+}
+
+/***********************************************************************************************************************
+ * int LZ77_findBlock(const struct lz77_index *, long long)
+ *
+ * Ricerca binaria del blocco che contiene il byte originale offset.
+ *
+ * @param index
+ * @param offset
+ * @return          --> indice del blocco, -1 se offset è oltre la fine del file
+ */
+int LZ77_findBlock(const struct lz77_index *index, long long offset){
+    int low = 0, high = index->blocks - 1, middle;
+
+    if(offset < 0 || offset >= index->raw_offset[index->blocks])
+        return -1;
+    while(low < high){
+        middle = low + (high - low + 1) / 2;
+        if(index->raw_offset[middle] <= offset)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+/***********************************************************************************************************************
+ * long LZ77_readBlock(struct lz77_context *, FILE *, const struct lz77_index *, int, unsigned char [])
+ *
+ * Decompressione del blocco block di un file con accesso casuale in raw (almeno BLOCK_SIZE byte): la lettura parte
+ * dalla posizione del blocco indicata dall'indice e l'intestazione del blocco deve corrispondere all'indice.
+ * L'array delle codifiche è quello del contesto (vedi LZ77_newContext).
+ *
+ * @param context
+ * @param infile
+ * @param index
+ * @param block
+ * @param raw
+ * @return          --> byte decompressi, -1 se il blocco è troncato o non valido
+ */
+long LZ77_readBlock(struct lz77_context *context, FILE *infile, const struct lz77_index *index, int block,
+                    unsigned char raw[]){
+    size_t raw_size, packed_size;
+    int type, eof = 0;
+
+    if(context->codes == NULL)
+        context->codes = malloc(context->batch * sizeof(struct code));
+    if(context->codes == NULL || block < 0 || block >= index->blocks ||
+       fseeko(infile, (off_t) index->packed_offset[block], SEEK_SET) != 0)
+        return -1;
+
+    type = getNextCode(&infile);
+    raw_size = readUint32(infile, &eof);
+    packed_size = readUint32(infile, &eof);
+    if(eof || (long long) raw_size != index->raw_offset[block + 1] - index->raw_offset[block] ||
+       (long long) packed_size + BLOCK_HEADER_SIZE != index->packed_offset[block + 1] - index->packed_offset[block] ||
+       (type == BLOCK_STORED && packed_size != raw_size) || (type != BLOCK_STORED && type != BLOCK_LZ77))
+        return -1;
+
+    if(decodeBlock(type, raw_size, packed_size, context->codes, context->batch, raw, raw, infile) == NULL)
+        return -1;
+    return (long) raw_size;
+}
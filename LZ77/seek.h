@@ -0,0 +1,36 @@
+/***********************************************************************************************************************
+ *
+ *  seek.h
+ *
+ *  File compressi con accesso casuale: blocchi indipendenti e indice dei blocchi (vedi seek.c).
+ *
+ **********************************************************************************************************************/
+
+#ifndef SEEK_H
+#define SEEK_H
+
+/*******************************************************INCLUDE********************************************************/
+
+#include "lz77.h"
+
+/*****************************************************STRUTTURE********************************************************/
+
+//Indice di un file compresso con accesso casuale: il blocco b contiene i byte originali da raw_offset[b] a
+//raw_offset[b + 1] - 1 e inizia alla posizione packed_offset[b] del file compresso
+struct lz77_index
+{
+    int blocks;
+    long long *raw_offset;          //blocks + 1 voci, l'ultima è la grandezza del file originale
+    long long *packed_offset;       //blocks + 1 voci, l'ultima è la posizione del blocco indice
+};
+
+/******************************************************FUNZIONI********************************************************/
+
+int LZ77_compressSeekable(FILE *infile, FILE *outfile);
+struct lz77_index *LZ77_readIndex(FILE *infile);
+void LZ77_freeIndex(struct lz77_index *index);
+int LZ77_findBlock(const struct lz77_index *index, long long offset);
+long LZ77_readBlock(struct lz77_context *context, FILE *infile, const struct lz77_index *index, int block,
+                    unsigned char raw[]);
+
+#endif
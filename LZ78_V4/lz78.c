@@ -0,0 +1,2708 @@
+/*
+ * Titolo: Algoritmo LZ78 (lz78.c)
+ *
+ * Corso: Algoritmi e strutture dati
+ * Autore: Elia Perrone
+ * Classe: I2A
+ *
+ * Descrizione: Progetto inerente gli algoritmi di compressione
+ * Inizio:  18.09.2017
+ * Fine:    19.01.2018
+ *
+ *
+ * Descrizione:
+ * LZ78 è un'algoritmo di compressione che abbandona il concetto di scorrimento della finestra, utilizzato nell'algorit-
+ * mo LZ77, e che implementa l'ideaologia di compressione sui dati futuri, e non sui dati già passati.
+ * Inoltre, LZ78 deve implementare la gestione di un dizionario.
+ * Di volta in volta, scorrendo l'intero file da comprimere, l'algoritmo LZ78 ricerca all'interno del suo dizionario,
+ * stringhe composte da sottostringhe, dove quest'ultime sono seguite da un carattere che rompe la sequenza di matching.
+ * Fattore importante di questo algoritmo, in confronto con l'LZ77, è che non abbiamo una restrizione su quando indietro
+ * puo essere ricercato un match. Data la gestione di un dizionario possiamo affermare che, se una stringa è memoriz-
+ * zata nel dizionario allora lo è anche un suo prefisso.
+ * Inoltre, il dizionario alla fine della compressione non viene inviato dunque, grazie alla flessibilità dell'algorit-
+ * mo possiamo ricostruirlo passo a passo durante la decompressione in maniera automatica.
+ *
+ *
+ * Pseudo-codice:
+ *
+ *   1:  begin
+ *   2:     initialize a dictionary by empty phrase P
+ *   3:     while (not EOF) do
+ *   4:      begin
+ *   5:        readSymbol(X)
+ *   6:        if (F.X> is in the dictionary) then
+ *   7:           F = F.X
+ *   8:        else
+ *   9:         begin
+ *  10:           output(pointer(F),X)
+ *  11:           encode X to the dictionary
+ *  12:           initialize phrase F by empty character
+ *  13:         end
+ *  14:        end
+ *  15:     end
+ *
+ *
+ * Scrittura bufferizzata:
+ *
+ *      **************************             Per ogni indice dell'elemento del dizionario conosco la grandezza, ovvero
+ *      *   INDICE   *     bit   *             quanti bit occurrono, per rappresentarlo.
+ *      **************************             La scrittura bufferizzata mi permette di usufruire di una grandezza
+ *      *      1      *    1     *             variabile dell'indice in maniera tale da poter risparmiare bit da scrivere
+ *      *      2      *    2     *             sul file compresso.
+ *      *      3      *    2     *
+ *      *      4      *    3     *
+ *      *      5      *    3     *             Al contrario durante la decompressine saprò che grandezza ha l'indice
+ *      *     ...     *   ...    *             dell'elemento da aggiungere nel dizionario dunque potro estrarre facil-
+ *      *      n      * log2(n)  *             mente le codifiche dal file compresso.
+ *      **************************
+ *
+ *
+ * Ogni codice è quindi scritto con index_bits(global_index) bit per l'indice seguiti da 8 bit per il carattere
+ * successivo. I bit sono accumulati in un intero a 64 bit e scritti a blocchi di byte (vedi write_bits e read_bits).
+ *
+ *
+ * Variante LZW (MODE_LZW):
+ * il dizionario inizia con tutti i 256 byte, quindi il carattere successivo non viene scritto: il codice è solamente
+ * l'indice della frase e il byte che interrompe la frase diventa l'inizio della frase successiva. A parità di dati i
+ * codici sono meno e più corti (vedi compress_lzw e decompress_lzw).
+ *
+ *
+ * Varianti LZMW (MODE_LZMW) e LZAP (MODE_LZAP):
+ * codici come LZW, ma le frasi crescono più velocemente di un byte per codice. Dopo ogni codice LZMW aggiunge la frase
+ * precedente seguita dalla frase corrente, LZAP la frase precedente seguita da ogni prefisso della frase corrente.
+ * Le ripetizioni lunghe vengono imparate in pochi codici, quindi servono meno codici per byte (compressione migliore e
+ * decompressione più veloce sui dati ripetitivi). Le frasi aggiunte sono lunghe al massimo MAX_PHRASE_LENGTH byte
+ * (vedi compress_lzap e compress_lzmw).
+ *
+ *
+ * Dati binari:
+ * compressione e decompressione lavorano su byte (nessuna funzione sulle stringhe), quindi qualsiasi file può essere
+ * compresso, compresi i byte a 0. Le frasi del dizionario non hanno una lunghezza massima: la lunghezza è limitata
+ * solo dal numero di elementi del dizionario (vedi write_long_phrase).
+ *
+ *
+ * File compresso:
+ * l'intestazione (vedi write_stream_header) contiene variante, gestione del dizionario pieno e grandezza del dizionario
+ * scelte con le opzioni del programma (vedi main.c), seguita dai codici e dalla loro fine (vedi flush_bits), con cui
+ * la decompressione riconosce un file troncato.
+ *
+ */
+
+
+/*********************************************** LIBRERIE *************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "lz78.h"
+
+#if LZ_HUGE_PAGES && defined(__linux__)
+#include <sys/mman.h>
+#define HUGE_PAGES_AVAILABLE 1
+#else
+#define HUGE_PAGES_AVAILABLE 0
+#endif
+
+/********************************************* VARIABILI GLOBALI ******************************************************/
+
+// indice generale per l'aggiunta di un elemento nel dizionario (uno per ogni thread)
+LZ_THREAD_LOCAL unsigned int global_index = 0;
+
+// quantità di elementi nel dizionario (scritta nell'intestazione del file compresso)
+unsigned int dictionary_size = DICTIONARY_SIZE;
+
+// grandezza dei blocchi compressi indipendentemente (scritta nell'intestazione del file compresso)
+unsigned int block_size = 0;
+
+// thread usati dalla compressione e decompressione a blocchi
+int threads = 1;
+
+// codifica dei codici, CODER_BITS o CODER_RANGE (scritta nell'intestazione del file compresso)
+int coder = CODER_BITS;
+
+// variante e gestione del dizionario pieno del codec lz78_codec (vedi LZ78_compress_buffer)
+int codec_mode = MODE_LZ78;
+int codec_policy = POLICY_RESET;
+
+// grandezza dei buffer del file da comprimere, dei byte decompressi e del file compresso (vedi fit_memory)
+size_t input_buffer_size = BUFFER_SIZE;
+size_t output_buffer_size = OUTPUT_SIZE;
+size_t stream_buffer_size = STREAM_BUFFER_SIZE;
+
+// limite di memoria del codec (0 = senza limite) e memoria stimata con i parametri scelti (vedi fit_memory)
+size_t memory_limit = 0;
+size_t memory_used = 0;
+
+#if LZ_STATS
+// statistiche della compressione (una copia per ogni thread)
+LZ_THREAD_LOCAL Stats stats;
+#endif
+
+/***********************************************************************************************************************
+                                                  FUNZIONI
+***********************************************************************************************************************/
+
+/*
+ * void inizialize_dictionary(Entry d[], int mode)
+ *
+ * Inizializzazione del dizionario della decompressione: per LZ78 l'elemento 0 è la frase vuota, per LZW (e LZMW, LZAP)
+ * gli elementi da 0 a 255 sono le frasi di un byte (gli altri elementi vengono scritti prima di essere usati)
+ *
+ */
+
+void inizialize_dictionary(Entry d[], int mode){
+    d[0].parent = 0;
+    d[0].length = 0;
+    d[0].value = '\0';
+    d[0].first = '\0';
+    if (mode != MODE_LZ78) {
+        for (unsigned int i = 0; i < 256; i++) {
+            d[i].parent = 0;
+            d[i].length = 1;
+            d[i].value = (unsigned char) i;
+            d[i].first = (unsigned char) i;
+        }
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void add_element(Entry d[], unsigned int index, unsigned int parent, unsigned char value)
+ *
+ * Aggiunta di un'elemento nel dizionario della decompressione:
+ *
+ * La frase con indice index è formata dalla frase parent seguita dal byte value, quindi per ogni elemento basta
+ * memorizzare l'indice del padre, l'ultimo byte e la lunghezza (12 byte invece della frase intera). Il primo byte
+ * della frase serve alla decompressione LZW.
+ *
+ */
+
+void add_element(Entry d[], unsigned int index, unsigned int parent, unsigned char value){
+    d[index].parent = parent;
+    d[index].length = d[parent].length + 1;
+    d[index].value = value;
+    d[index].first = d[parent].length == 0 ? value : d[parent].first;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int search_element_by_index(Entry d[], unsigned int index, unsigned char value[])
+ *
+ * Ricostruzione della frase con indice index: la lunghezza è nota, quindi la frase viene scritta all'indietro a
+ * partire dall'ultimo byte seguendo gli indici dei padri fino alla frase vuota (un accesso al dizionario per byte).
+ *
+ * @return lunghezza della frase scritta in value
+ *
+ */
+
+unsigned int search_element_by_index(Entry d[], unsigned int index, unsigned char value[]){
+    unsigned int length = d[index].length;
+    for (unsigned int i = length; i > 0; i--) {
+        value[i-1] = d[index].value;
+        index = d[index].parent;
+    }
+    return length;
+}
+
+/***********************************************************************************************************************
+                                            MEMORIA DEL DIZIONARIO
+ **********************************************************************************************************************/
+
+/*
+ * Arena *arena_create(size_t size)
+ *
+ * Creazione di una zona di memoria contigua da cui vengono presi tutti gli elementi del dizionario (tabella del trie,
+ * elementi della decompressione, liste della gestione del dizionario pieno): una sola allocazione all'inizio invece
+ * di una per struttura, e le strutture usate insieme sono vicine in memoria.
+ * Con -DLZ_HUGE_PAGES=1 (solo Linux) la memoria viene chiesta in pagine da 2 MB (meno TLB miss sui dizionari grandi):
+ * prima le huge pages riservate (MAP_HUGETLB), poi le transparent huge pages (madvise), altrimenti calloc.
+ *
+ * @return zona di memoria azzerata di size byte (NULL se non c'è abbastanza memoria), da liberare con arena_free
+ *
+ */
+
+Arena *arena_create(size_t size){
+    Arena *a = malloc(sizeof(Arena));
+
+    if(a==NULL) return NULL;
+    a->size = size;
+    a->used = 0;
+    a->mapped = 0;
+#if HUGE_PAGES_AVAILABLE
+    if (size >= HUGE_PAGE_SIZE) {
+        size_t mapped = (size + HUGE_PAGE_SIZE - 1) & ~(size_t) (HUGE_PAGE_SIZE - 1);
+        void *memory = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED) madvise(memory, mapped, MADV_HUGEPAGE);
+        }
+        if (memory != MAP_FAILED) {
+            a->memory = memory;
+            a->size = mapped;
+            a->mapped = 1;
+            return a;
+        }
+    }
+#endif
+    a->memory = calloc(size, 1);
+    if(a->memory==NULL) {
+        free(a);
+        return NULL;
+    }
+    return a;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void *arena_alloc(Arena *a, size_t bytes)
+ *
+ * Assegnazione di bytes byte della zona di memoria (allineati a ARENA_ALIGN byte, una riga di cache): basta spostare
+ * il numero di byte usati, la memoria viene liberata tutta insieme da arena_free
+ *
+ * @return memoria azzerata, NULL se la zona di memoria è finita
+ *
+ */
+
+void *arena_alloc(Arena *a, size_t bytes){
+    void *memory;
+
+    if (ARENA_BYTES(bytes) > a->size - a->used) return NULL;
+    memory = a->memory + a->used;
+    a->used = a->used + ARENA_BYTES(bytes);
+    return memory;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void arena_free(Arena *a)
+ *
+ * Cancellazione della zona di memoria e di tutte le strutture prese da essa
+ *
+ */
+
+void arena_free(Arena *a){
+    if(a==NULL) return;
+#if HUGE_PAGES_AVAILABLE
+    if (a->mapped) {
+        munmap(a->memory, a->size);
+        free(a);
+        return;
+    }
+#endif
+    free(a->memory);
+    free(a);
+}
+
+/***********************************************************************************************************************
+                                              TRIE DELLE FRASI
+ **********************************************************************************************************************/
+
+/*
+ * unsigned int trie_table_bits(unsigned int dictionary_size)
+ *
+ * log2 del numero di posizioni della tabella del trie: potenza di 2 almeno doppia del numero di elementi
+ *
+ */
+
+static unsigned int trie_table_bits(unsigned int dictionary_size){
+    unsigned int bits = 1;
+    while ((1u << bits) < 2 * dictionary_size)
+        bits++;
+    return bits;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t trie_bytes(unsigned int dictionary_size)
+ *
+ * Memoria usata da create_trie (da aggiungere alla grandezza della zona di memoria)
+ *
+ */
+
+size_t trie_bytes(unsigned int dictionary_size){
+    return ARENA_BYTES(sizeof(Trie)) + ARENA_BYTES(((size_t) 1 << trie_table_bits(dictionary_size)) * sizeof(Slot));
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * Trie *create_trie(Arena *a, unsigned int dictionary_size)
+ *
+ * Creazione del dizionario usato dalla compressione.
+ * Ogni frase del dizionario è formata da una frase già presente (padre) più un byte, quindi il dizionario è un trie e
+ * la ricerca della frase estesa di un byte è la ricerca della coppia (indice padre, byte) invece della scansione di
+ * tutto il dizionario. La frase vuota ha indice 0.
+ *
+ * Le coppie sono memorizzate in una tabella hash ad indirizzamento aperto con scansione lineare:
+ *
+ *      *********************************************************
+ *      *  padre << 8 | byte  *  generazione  *  indice  *       numero di posizioni: potenza di 2 almeno doppia del
+ *      *********************************************************       numero di elementi del dizionario (tabella
+ *      *        ...          *      ...      *   ...    *       piena al massimo per metà), quindi le ricerche
+ *      *********************************************************       confrontano in media poche posizioni vicine.
+ *
+ * Con il dizionario di 10000 elementi la tabella occupa 256 KB (entra nella cache L2), la chiave a 32 bit permette
+ * dizionari fino a 2^24 elementi.
+ *
+ * Una posizione è occupata solamente se la sua generazione è quella attuale del dizionario: l'inizializzazione del
+ * dizionario pieno incrementa la generazione e libera tutte le posizioni in O(1) (vedi inizialize_trie).
+ *
+ * @return dizionario inizializzato preso dalla zona di memoria a (NULL se non c'è abbastanza memoria, vedi trie_bytes)
+ *
+ */
+
+Trie *create_trie(Arena *a, unsigned int dictionary_size){
+    unsigned int bits = trie_table_bits(dictionary_size);
+    Trie *t = arena_alloc(a, sizeof(Trie));
+
+    if(t==NULL) return NULL;
+    t->slots = arena_alloc(a, ((size_t) 1 << bits) * sizeof(Slot));      // memoria azzerata: tutte le posizioni libere
+    if(t->slots==NULL) return NULL;
+    t->mask = (1u << bits) - 1;
+    t->shift = 32 - bits;
+    t->generation = 1;
+    return t;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void inizialize_trie(Trie *t)
+ *
+ * Inizializzazione del dizionario: tutte le posizioni della tabella vengono liberate incrementando la generazione.
+ * Solo quando la generazione (8 bit) ricomincia da capo la tabella viene azzerata, una volta ogni 255 inizializzazioni.
+ *
+ */
+
+void inizialize_trie(Trie *t){
+    t->generation++;
+    if (t->generation > MAX_GENERATION) {
+        memset(t->slots, 0, ((size_t) t->mask + 1) * sizeof(Slot));
+        t->generation = 1;
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int hash_position(Trie *t, unsigned int key)
+ *
+ * Prima posizione della tabella in cui cercare una chiave (hash moltiplicativo: i bit più alti del prodotto dipendono
+ * da tutti i bit della chiave)
+ *
+ */
+
+static unsigned int hash_position(Trie *t, unsigned int key){
+    return (unsigned int) ((key * 2654435761u) & 0xFFFFFFFFu) >> t->shift;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int search_child(Trie *t, unsigned int parent, unsigned char value)
+ *
+ * Ricerca della frase formata dalla frase parent seguita dal byte value: le posizioni vengono confrontate a partire
+ * da quella data dalla funzione hash fino alla chiave cercata o alla prima posizione libera
+ *
+ * @return  0 -> se la frase non è presente nel dizionario
+ *          n -> indice della frase nel dizionario
+ *
+ */
+
+unsigned int search_child(Trie *t, unsigned int parent, unsigned char value){
+    unsigned int key = parent << 8 | value;
+    unsigned int position = hash_position(t, key);
+    STATS_INC(stats.searches);
+    while (t->slots[position].generation == t->generation) {
+        STATS_INC(stats.probes);
+        if (t->slots[position].key == key)
+            return t->slots[position].index;
+        position = (position + 1) & t->mask;
+    }
+    STATS_INC(stats.probes);
+    return 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void add_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index)
+ *
+ * Aggiunta nel dizionario della frase formata dalla frase parent seguita dal byte value, con l'indice index (la frase
+ * non deve essere già presente, viene inserita nella prima posizione libera)
+ *
+ */
+
+void add_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index){
+    unsigned int key = parent << 8 | value;
+    unsigned int position = hash_position(t, key);
+    while (t->slots[position].generation == t->generation)
+        position = (position + 1) & t->mask;
+    t->slots[position].key = key;
+    t->slots[position].index = index;
+    t->slots[position].generation = t->generation;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void remove_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index)
+ *
+ * Rimozione dal dizionario della frase con indice index formata dalla frase parent seguita dal byte value (se la
+ * coppia ha un altro indice non viene rimossa: con LZAP la stessa coppia può avere più indici, vedi lzap_add).
+ * Con la scansione lineare non basta liberare la posizione: le chiavi successive della stessa sequenza di posizioni
+ * occupate che potrebbero non essere più trovate vengono spostate indietro nella posizione liberata.
+ *
+ */
+
+void remove_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index){
+    unsigned int key = parent << 8 | value;
+    unsigned int position = hash_position(t, key);
+    unsigned int next, home;
+
+    while (t->slots[position].generation == t->generation) {
+        if (t->slots[position].key == key && t->slots[position].index == index) break;
+        position = (position + 1) & t->mask;
+    }
+    if (t->slots[position].generation != t->generation)
+        return;
+
+    next = position;
+    while (1) {
+        next = (next + 1) & t->mask;
+        if (t->slots[next].generation != t->generation) break;
+        home = hash_position(t, t->slots[next].key);
+        // la chiave in next può essere spostata se la posizione liberata non è prima della sua posizione iniziale
+        if (((next - home) & t->mask) >= ((next - position) & t->mask)) {
+            t->slots[position] = t->slots[next];
+            position = next;
+        }
+    }
+    t->slots[position].generation = 0;
+}
+
+
+/***********************************************************************************************************************
+                                           GESTIONE DEL DIZIONARIO PIENO
+ **********************************************************************************************************************/
+
+/*
+ * unsigned int empty_index(int mode)
+ *
+ * Ultimo indice del dizionario appena inizializzato: 0 (frase vuota) per LZ78, 255 per LZW, LZMW e LZAP (i 256 byte)
+ *
+ */
+
+static unsigned int empty_index(int mode){
+    return mode == MODE_LZ78 ? 0 : 255;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t policy_bytes(int type, unsigned int dictionary_size)
+ *
+ * Memoria usata da create_policy (da aggiungere alla grandezza della zona di memoria)
+ *
+ */
+
+size_t policy_bytes(int type, unsigned int dictionary_size){
+    size_t n = (size_t) dictionary_size + 1;
+    if (type != POLICY_LRU)
+        return ARENA_BYTES(sizeof(Policy));
+    return ARENA_BYTES(sizeof(Policy)) + 4 * ARENA_BYTES(n * sizeof(unsigned int)) + ARENA_BYTES(n);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * Policy *create_policy(Arena *a, int type, int mode)
+ *
+ * Creazione della gestione del dizionario pieno. Quando global_index arriva a dictionary_size:
+ *
+ *  POLICY_RESET     il dizionario viene inizializzato e si riparte da un dizionario vuoto (tutte le frasi imparate
+ *                   vengono perse e il rapporto di compressione crolla finchè il dizionario non si riempie di nuovo)
+ *  POLICY_FREEZE    il dizionario non cambia più: adatto ai file con contenuto uniforme
+ *  POLICY_MONITOR   come il programma compress: il dizionario non cambia ma ogni RATIO_INTERVAL byte il rapporto di
+ *                   compressione dall'ultima inizializzazione viene confrontato con quello del controllo precedente,
+ *                   il dizionario viene inizializzato solo se il rapporto è peggiorato (i dati sono cambiati)
+ *  POLICY_LRU       la nuova frase prende l'indice della foglia (frase che non è prefisso di altre frasi) aggiunta o
+ *                   estesa meno di recente, le frasi usate di frequente restano nel dizionario
+ *
+ * Compressione e decompressione fanno le stesse chiamate a dictionary_add con gli stessi contatori (byte elaborati e
+ * bit del file compresso), quindi il dizionario della decompressione rimane uguale a quello della compressione senza
+ * scrivere niente in più nel file compresso. Con LZMW il dizionario può essere pieno prima di dictionary_size elementi
+ * (p->limit, vedi lzmw_add), POLICY_LRU non è disponibile (le frasi LZMW non formano un trie).
+ *
+ * @return gestione del dizionario presa dalla zona di memoria a (NULL se non c'è abbastanza memoria, vedi policy_bytes)
+ *
+ */
+
+Policy *create_policy(Arena *a, int type, int mode){
+    size_t n = (size_t) dictionary_size + 1;
+    Policy *p = arena_alloc(a, sizeof(Policy));             // memoria azzerata: contatori a 0 e liste vuote
+
+    if(p==NULL) return NULL;
+    p->type = type;
+    p->base = empty_index(mode);
+    p->limit = dictionary_size;
+    if (mode == MODE_LZMW) p->max_nodes = lzmw_nodes(dictionary_size);
+    if (type == POLICY_LRU) {
+        p->parent = arena_alloc(a, n * sizeof(unsigned int));
+        p->children = arena_alloc(a, n * sizeof(unsigned int));
+        p->older = arena_alloc(a, n * sizeof(unsigned int));
+        p->newer = arena_alloc(a, n * sizeof(unsigned int));
+        p->value = arena_alloc(a, n);
+        if(p->parent==NULL || p->value==NULL || p->children==NULL || p->older==NULL || p->newer==NULL)
+            return NULL;
+    }
+    return p;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void lru_append(Policy *p, unsigned int index)
+ * void lru_remove(Policy *p, unsigned int index)
+ *
+ * Aggiunta di una foglia in fondo alla lista (la più recente) e rimozione di una foglia dalla lista
+ *
+ */
+
+static void lru_append(Policy *p, unsigned int index){
+    p->older[index] = p->newest;
+    p->newer[index] = 0;
+    if (p->newest != 0) p->newer[p->newest] = index;
+    else p->oldest = index;
+    p->newest = index;
+}
+
+static void lru_remove(Policy *p, unsigned int index){
+    if (p->older[index] != 0) p->newer[p->older[index]] = p->newer[index];
+    else p->oldest = p->newer[index];
+    if (p->newer[index] != 0) p->older[p->newer[index]] = p->older[index];
+    else p->newest = p->older[index];
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void lru_insert(Policy *p, unsigned int index, unsigned int parent, unsigned char value)
+ *
+ * La frase index (parent seguita da value) è una nuova foglia, mentre parent smette di esserlo (le frasi del
+ * dizionario vuoto non vengono mai sostituite e non sono nella lista)
+ *
+ */
+
+static void lru_insert(Policy *p, unsigned int index, unsigned int parent, unsigned char value){
+    p->parent[index] = parent;
+    p->value[index] = value;
+    p->children[index] = 0;
+    if (parent > p->base && p->children[parent]++ == 0)
+        lru_remove(p, parent);
+    lru_append(p, index);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int lru_evict(Policy *p, Trie *t, unsigned int parent, unsigned char value)
+ *
+ * Sostituzione della foglia meno recente con la frase parent seguita da value (parent non può essere sostituita).
+ * La frase sostituita viene tolta dal trie della compressione e il suo padre, se rimane senza figli, diventa la
+ * foglia più recente.
+ *
+ * @return indice della nuova frase (0 se non ci sono foglie da sostituire)
+ *
+ */
+
+static unsigned int lru_evict(Policy *p, Trie *t, unsigned int parent, unsigned char value){
+    unsigned int victim = p->oldest, old_parent;
+
+    if (victim == parent) victim = p->newer[victim];
+    if (victim == 0) return 0;
+    lru_remove(p, victim);
+    if (t != NULL) remove_child(t, p->parent[victim], p->value[victim], victim);
+    old_parent = p->parent[victim];
+    if (old_parent > p->base && --p->children[old_parent] == 0)
+        lru_append(p, old_parent);
+    lru_insert(p, victim, parent, value);
+    STATS_INC(stats.evictions);
+    return victim;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void reset_dictionary(Policy *p, Trie *t, unsigned long long bytes, unsigned long long bits)
+ *
+ * Inizializzazione del dizionario pieno: nella compressione anche il trie (in O(1), vedi inizialize_trie), nella
+ * decompressione basta ripartire da global_index (gli elementi vengono riscritti prima di essere usati)
+ *
+ */
+
+static void reset_dictionary(Policy *p, Trie *t, unsigned long long bytes, unsigned long long bits){
+    STATS_INC(stats.resets);
+    global_index = p->base;
+    p->limit = dictionary_size;
+    p->nodes = 0;
+    if (t != NULL) inizialize_trie(t);
+    p->reset = 1;
+    p->reset_bytes = bytes;
+    p->reset_bits = bits;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int dictionary_add(Policy *p, Trie *t, unsigned int parent, unsigned char value, unsigned long long bytes,
+ *                             unsigned long long bits)
+ *
+ * Scelta dell'indice della nuova frase parent seguita da value, chiamata dopo ogni codice scritto (compressione, t è
+ * il trie) o letto (decompressione, t = NULL).
+ *
+ * @param bytes --> byte elaborati compresa la frase del codice
+ * @param bits  --> bit del file compresso compreso il codice
+ *
+ * @return indice della nuova frase, 0 se la frase non va aggiunta (dizionario pieno o appena inizializzato: in
+ *         questo caso p->reset è 1)
+ *
+ */
+
+unsigned int dictionary_add(Policy *p, Trie *t, unsigned int parent, unsigned char value, unsigned long long bytes,
+                            unsigned long long bits){
+    unsigned long long in, out;
+
+    p->reset = 0;
+    if (global_index < p->limit) {                          // c'è ancora posto nel dizionario
+        global_index++;
+        if (p->type == POLICY_LRU) lru_insert(p, global_index, parent, value);
+        if (global_index < p->limit) return global_index;
+        if (p->type == POLICY_RESET) {                      // l'ultima frase non viene usata (come nelle versioni precedenti)
+            reset_dictionary(p, t, bytes, bits);
+            return 0;
+        }
+        if (p->type == POLICY_MONITOR) {                    // primo rapporto di compressione da confrontare
+            p->best_bytes = bytes - p->reset_bytes;
+            p->best_bits = bits - p->reset_bits;
+            p->checkpoint = bytes + RATIO_INTERVAL;
+        }
+        return global_index;
+    }
+
+    switch (p->type) {
+        case POLICY_LRU:
+            return lru_evict(p, t, parent, value);
+
+        case POLICY_MONITOR:
+            if (bytes < p->checkpoint) return 0;
+            in = bytes - p->reset_bytes;
+            out = bits - p->reset_bits;
+            if ((double) in * (double) p->best_bits >= (double) p->best_bytes * (double) out) {
+                p->best_bytes = in;                         // il rapporto non è peggiorato: tengo il dizionario
+                p->best_bits = out;
+                p->checkpoint = bytes + RATIO_INTERVAL;
+            } else {
+                reset_dictionary(p, t, bytes, bits);
+            }
+            return 0;
+
+        default:                                            // POLICY_FREEZE (POLICY_RESET non arriva mai al dizionario pieno)
+            return 0;
+    }
+}
+
+
+/***********************************************************************************************************************
+                                               SCRITTURA SU FILE
+ **********************************************************************************************************************/
+
+/*
+ * unsigned int index_bits(unsigned int last_index)
+ *
+ * Numero di bit con cui viene scritto un indice quando l'ultimo elemento aggiunto al dizionario ha indice last_index
+ * (l'indice scritto è compreso tra 0 e last_index): ceil(log2(last_index+1)), vedi la tabella all'inizio del file.
+ *
+ */
+
+unsigned int index_bits(unsigned int last_index){
+#if defined(__GNUC__)
+    return last_index == 0 ? 0 : 32 - (unsigned int) __builtin_clz(last_index);     // una sola istruzione sulle CPU moderne
+#else
+    unsigned int bits = 0;
+    while (last_index != 0) {
+        bits++;
+        last_index = last_index >> 1;
+    }
+    return bits;
+#endif
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * BitWriter *create_bit_writer(void)
+ * BitReader *create_bit_reader(void)
+ *
+ * Allocazione della scrittura e della lettura bufferizzata con un buffer di byte di stream_buffer_size byte
+ *
+ * @return struttura da liberare con free (NULL se non c'è abbastanza memoria)
+ *
+ */
+
+BitWriter *create_bit_writer(void){
+    BitWriter *w = malloc(sizeof(BitWriter) + stream_buffer_size);
+    if (w != NULL) w->capacity = stream_buffer_size;
+    return w;
+}
+
+BitReader *create_bit_reader(void){
+    BitReader *r = malloc(sizeof(BitReader) + stream_buffer_size);
+    if (r != NULL) r->capacity = stream_buffer_size;
+    return r;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void bit_writer_init(BitWriter *w, FILE *file)
+ *
+ * Inizializzazione della scrittura bufferizzata sul file compresso (w creato da create_bit_writer)
+ *
+ */
+
+void bit_writer_init(BitWriter *w, FILE *file){
+    w->file = file;
+    w->bits = 0;
+    w->count = 0;
+    w->position = 0;
+    w->total = 0;
+    w->model = NULL;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void write_bits(BitWriter *w, unsigned int value, unsigned int n)
+ *
+ * Scrittura bufferizzata dei n bit meno significativi di value (n <= 32, dal bit più significativo).
+ * I bit vengono accumulati in un intero a 64 bit, ogni byte completo passa nel buffer di byte che viene scritto sul
+ * file con fwrite quando è pieno: nessuna conversione bit per bit e nessuna chiamata di libreria per ogni byte.
+ *
+ */
+
+void write_bits(BitWriter *w, unsigned int value, unsigned int n){
+    // copie locali: le scritture nel buffer di byte non obbligano il compilatore a rileggere i campi di w
+    unsigned long long bits = (w->bits << n) | (value & (n < 32 ? (1u << n) - 1 : 0xFFFFFFFFu));
+    unsigned int count = w->count + n;
+    size_t position = w->position, capacity = w->capacity;
+
+    PHASE_PUSH(PHASE_PACK);
+    w->total = w->total + n;
+    while (count >= 8) {
+        count = count - 8;
+        w->bytes[position++] = (unsigned char) (bits >> count);
+        if (position == capacity) {
+            PHASE_PUSH(PHASE_WRITE);
+            fwrite(w->bytes, sizeof(unsigned char), position, w->file);
+            PHASE_POP();
+            position = 0;
+        }
+    }
+    w->bits = bits;
+    w->count = count;
+    w->position = position;
+    PHASE_POP();
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void bit_reader_init(BitReader *r, FILE *file)
+ *
+ * Inizializzazione della lettura bufferizzata del file compresso (r creato da create_bit_reader)
+ *
+ */
+
+void bit_reader_init(BitReader *r, FILE *file){
+    r->file = file;
+    r->bits = 0;
+    r->count = 0;
+    r->position = 0;
+    r->size = 0;
+    r->total = 0;
+    r->model = NULL;
+    r->error = 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int read_bits(BitReader *r, unsigned int n, unsigned int *value)
+ *
+ * Lettura bufferizzata di n bit (n <= 32): stesso ordine dei bit di write_bits, il file viene letto con fread a
+ * blocchi di r->capacity byte. Gli ultimi CODES_TRAILER_SIZE byte letti restano nel buffer finché il file non ne ha
+ * altri: alla fine del file sono il numero di bit dei codici scritto da flush_bits e vengono confrontati con i bit
+ * letti (r->error = 1 se il file compresso è troncato).
+ *
+ * @return  1 -> se i bit sono stati letti (in value)
+ *          0 -> se il file compresso è finito
+ *
+ */
+
+static unsigned int get_uint32(const unsigned char bytes[]);
+
+int read_bits(BitReader *r, unsigned int n, unsigned int *value){
+    unsigned long long bits = r->bits;
+    unsigned int count = r->count;
+    size_t kept, readed;
+
+    while (count < n) {
+        if (r->size - r->position <= CODES_TRAILER_SIZE) {
+            kept = r->size - r->position;
+            memmove(r->bytes, &r->bytes[r->position], kept);
+            PHASE_PUSH(PHASE_READ);
+            readed = fread(&r->bytes[kept], sizeof(unsigned char), r->capacity - kept, r->file);
+            PHASE_POP();
+            r->position = 0;
+            r->size = kept + readed;
+            if (readed == 0) {
+                r->bits = bits;
+                r->count = count;
+                if (kept != CODES_TRAILER_SIZE || count >= 8 || get_uint32(r->bytes) != (unsigned int) r->total)
+                    r->error = 1;
+                return 0;
+            }
+            continue;
+        }
+        bits = (bits << 8) | r->bytes[r->position++];
+        count = count + 8;
+    }
+    count = count - n;
+    *value = (unsigned int) (bits >> count) & (n < 32 ? (1u << n) - 1 : 0xFFFFFFFFu);
+    r->bits = bits;
+    r->count = count;
+    r->total = r->total + n;
+    return 1;
+}
+
+/**********************************************************************************************************************/
+
+/***********************************************************************************************************************
+                                               CODIFICA ARITMETICA
+ **********************************************************************************************************************/
+
+/*
+ * void model_init(Model *m)
+ *
+ * Inizializzazione delle probabilità della codifica aritmetica: ogni bit ha probabilità 1/2 di essere 0
+ *
+ */
+
+static void model_init(Model *m){
+    unsigned short half = 1 << (PROBABILITY_BITS - 1);
+
+    m->end = half;
+    for (int i = 0; i < INDEX_SLOTS; i++) {
+        for (int j = 0; j < 32; j++) m->slot[i][j] = half;
+        for (int j = 0; j < (1 << INDEX_MODEL_BITS); j++) m->high[i][j] = half;
+    }
+    for (int i = 0; i < 256; i++) {
+        for (int j = 0; j < 256; j++) m->value[i][j] = half;
+    }
+    m->last = 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void range_writer_init(BitWriter *w, Model *m)
+ * void range_reader_init(BitReader *r, Model *m)
+ *
+ * Codifica aritmetica dei codici (dopo bit_writer_init e bit_reader_init): i codici non vengono più scritti con un
+ * numero fisso di bit ma come un numero in un intervallo che si restringe ad ogni bit in proporzione alla probabilità
+ * del bit (vedi encode_bit), quindi i bit frequenti costano meno di un bit. Le probabilità sono in m e si adattano ai
+ * dati durante la compressione e allo stesso modo durante la decompressione, senza scriverle nel file compresso.
+ * La lettura legge subito i primi 5 byte (il primo è sempre 0).
+ *
+ */
+
+void range_writer_init(BitWriter *w, Model *m){
+    model_init(m);
+    w->model = m;
+    w->low = 0;
+    w->range = 0xFFFFFFFFu;
+    w->cache = 0;
+    w->cache_size = 1;
+}
+
+static unsigned char get_byte(BitReader *r);
+
+void range_reader_init(BitReader *r, Model *m){
+    model_init(m);
+    r->model = m;
+    r->range = 0xFFFFFFFFu;
+    r->code = 0;
+    r->missing = 0;
+    for (int i = 0; i < 5; i++)
+        r->code = r->code << 8 | get_byte(r);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void put_byte(BitWriter *w, unsigned char value)
+ * unsigned char get_byte(BitReader *r)
+ *
+ * Scrittura e lettura di un byte della codifica aritmetica nel buffer di byte (scritto con fwrite quando è pieno,
+ * letto con fread quando è vuoto). Dopo la fine del file compresso get_byte restituisce 0 e conta i byte mancanti.
+ *
+ */
+
+static void put_byte(BitWriter *w, unsigned char value){
+    w->bytes[w->position++] = value;
+    if (w->position == w->capacity) {
+        PHASE_PUSH(PHASE_WRITE);
+        fwrite(w->bytes, sizeof(unsigned char), w->position, w->file);
+        PHASE_POP();
+        w->position = 0;
+    }
+}
+
+static unsigned char get_byte(BitReader *r){
+    if (r->position == r->size) {
+        PHASE_PUSH(PHASE_READ);
+        r->size = fread(r->bytes, sizeof(unsigned char), r->capacity, r->file);
+        PHASE_POP();
+        r->position = 0;
+        if (r->size == 0) {
+            r->missing++;
+            return 0;
+        }
+    }
+    return r->bytes[r->position++];
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void shift_low(BitWriter *w)
+ *
+ * Scrittura del byte più significativo dell'inizio dell'intervallo. Il byte può ancora cambiare se una somma
+ * successiva produce un riporto, quindi rimane in cache (con i byte 0xFF che lo seguono, che diventerebbero 0) finchè
+ * il riporto non è più possibile.
+ *
+ */
+
+static void shift_low(BitWriter *w){
+    if ((unsigned int) w->low < 0xFF000000u || (w->low >> 32) != 0) {
+        unsigned char carry = (unsigned char) (w->low >> 32);
+        unsigned char value = w->cache;
+        do {
+            put_byte(w, (unsigned char) (value + carry));
+            value = 0xFF;
+        } while (--w->cache_size != 0);
+        w->cache = (unsigned char) (w->low >> 24);
+    }
+    w->cache_size++;
+    w->low = (w->low & 0x00FFFFFFu) << 8;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void encode_bit(BitWriter *w, unsigned short *probability, unsigned int bit)
+ * unsigned int decode_bit(BitReader *r, unsigned short *probability)
+ *
+ * Codifica di un bit con probabilità *probability / 2^PROBABILITY_BITS di essere 0: l'intervallo viene diviso in
+ * proporzione alla probabilità e si tiene la parte del bit, poi la probabilità si sposta verso il bit codificato.
+ * Quando l'intervallo è più piccolo di RANGE_TOP viene scritto (letto) un byte. Compressione e decompressione
+ * scrivono e leggono un byte negli stessi momenti, quindi total (8 bit per byte) è uguale in entrambe.
+ *
+ */
+
+static void encode_bit(BitWriter *w, unsigned short *probability, unsigned int bit){
+    unsigned int bound = (w->range >> PROBABILITY_BITS) * *probability;
+
+    if (bit == 0) {
+        w->range = bound;
+        *probability = (unsigned short) (*probability + (((1 << PROBABILITY_BITS) - *probability) >> PROBABILITY_SHIFT));
+    } else {
+        w->low = w->low + bound;
+        w->range = w->range - bound;
+        *probability = (unsigned short) (*probability - (*probability >> PROBABILITY_SHIFT));
+    }
+    while (w->range < RANGE_TOP) {
+        w->range = w->range << 8;
+        shift_low(w);
+        w->total = w->total + 8;
+    }
+}
+
+static unsigned int decode_bit(BitReader *r, unsigned short *probability){
+    unsigned int bound = (r->range >> PROBABILITY_BITS) * *probability, bit;
+
+    if (r->code < bound) {
+        r->range = bound;
+        *probability = (unsigned short) (*probability + (((1 << PROBABILITY_BITS) - *probability) >> PROBABILITY_SHIFT));
+        bit = 0;
+    } else {
+        r->code = r->code - bound;
+        r->range = r->range - bound;
+        *probability = (unsigned short) (*probability - (*probability >> PROBABILITY_SHIFT));
+        bit = 1;
+    }
+    while (r->range < RANGE_TOP) {
+        r->range = r->range << 8;
+        r->code = r->code << 8 | get_byte(r);
+        r->total = r->total + 8;
+    }
+    return bit;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void encode_direct(BitWriter *w, unsigned int value, unsigned int n)
+ * unsigned int decode_direct(BitReader *r, unsigned int n)
+ *
+ * Codifica degli n bit meno significativi di value con probabilità fissa 1/2 (un bit ciascuno, senza probabilità)
+ *
+ */
+
+static void encode_direct(BitWriter *w, unsigned int value, unsigned int n){
+    while (n-- > 0) {
+        w->range = w->range >> 1;
+        if ((value >> n) & 1) w->low = w->low + w->range;
+        while (w->range < RANGE_TOP) {
+            w->range = w->range << 8;
+            shift_low(w);
+            w->total = w->total + 8;
+        }
+    }
+}
+
+static unsigned int decode_direct(BitReader *r, unsigned int n){
+    unsigned int value = 0;
+
+    while (n-- > 0) {
+        r->range = r->range >> 1;
+        value = value << 1;
+        if (r->code >= r->range) {
+            r->code = r->code - r->range;
+            value = value | 1;
+        }
+        while (r->range < RANGE_TOP) {
+            r->range = r->range << 8;
+            r->code = r->code << 8 | get_byte(r);
+            r->total = r->total + 8;
+        }
+    }
+    return value;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void encode_tree(BitWriter *w, unsigned short probabilities[], unsigned int value, unsigned int n)
+ * unsigned int decode_tree(BitReader *r, unsigned short probabilities[], unsigned int n)
+ *
+ * Codifica di un valore di n bit dal bit più significativo: ogni bit ha la sua probabilità, scelta dai bit già
+ * codificati (albero binario di 2^n - 1 probabilità, la radice è probabilities[1])
+ *
+ */
+
+static void encode_tree(BitWriter *w, unsigned short probabilities[], unsigned int value, unsigned int n){
+    unsigned int context = 1, bit;
+
+    while (n-- > 0) {
+        bit = (value >> n) & 1;
+        encode_bit(w, &probabilities[context], bit);
+        context = context << 1 | bit;
+    }
+}
+
+static unsigned int decode_tree(BitReader *r, unsigned short probabilities[], unsigned int n){
+    unsigned int context = 1;
+
+    for (unsigned int i = 0; i < n; i++)
+        context = context << 1 | decode_bit(r, &probabilities[context]);
+    return context - (1u << n);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void encode_index(BitWriter *w, unsigned int index)
+ * unsigned int decode_index(BitReader *r, unsigned int last_index)
+ *
+ * Codifica aritmetica di un indice del dizionario: prima il numero di bit dell'indice (da 0 a 24, con le probabilità
+ * scelte dal numero di bit dell'ultimo indice del dizionario), poi i INDEX_MODEL_BITS bit dopo il primo bit a 1 con
+ * le loro probabilità (per numero di bit) e gli altri bit con probabilità 1/2, come le distanze di LZMA.
+ *
+ * @return indice letto (maggiore di last_index se il file compresso non è valido)
+ *
+ */
+
+static void encode_index(BitWriter *w, unsigned int index){
+    Model *m = w->model;
+    unsigned int slot = index_bits(index), extra, top;
+
+    encode_tree(w, m->slot[index_bits(global_index)], slot, 5);
+    if (slot < 2) return;                                   // 0 e 1: il numero di bit è l'indice
+    extra = slot - 1;                                       // bit dopo il primo bit a 1
+    top = extra < INDEX_MODEL_BITS ? extra : INDEX_MODEL_BITS;
+    encode_tree(w, m->high[slot], (index >> (extra - top)) & ((1u << top) - 1), top);
+    encode_direct(w, index, extra - top);
+}
+
+static unsigned int decode_index(BitReader *r, unsigned int last_index){
+    Model *m = r->model;
+    unsigned int slot = decode_tree(r, m->slot[index_bits(last_index)], 5), extra, top, index;
+
+    if (slot >= INDEX_SLOTS) return 0xFFFFFFFFu;
+    if (slot < 2) return slot;
+    extra = slot - 1;
+    top = extra < INDEX_MODEL_BITS ? extra : INDEX_MODEL_BITS;
+    index = 1u << extra | decode_tree(r, m->high[slot], top) << (extra - top);
+    return index | decode_direct(r, extra - top);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void flush_bits(BitWriter *w)
+ *
+ * Scrittura sul file dei bit rimasti: l'ultimo byte viene completato con bit a 0 (da eseguire a fine compressione)
+ * ed è seguito dal numero di bit dei codici in CODES_TRAILER_SIZE byte (little endian, modulo 2^32), che permette a
+ * read_bits di riconoscere un file troncato. Con la codifica aritmetica viene invece codificata la fine dei codici e
+ * scritto tutto l'intervallo rimasto.
+ *
+ */
+
+static void put_uint32(unsigned char bytes[], unsigned int value);
+
+void flush_bits(BitWriter *w){
+    unsigned char trailer[CODES_TRAILER_SIZE];
+
+    if (w->model != NULL) {
+        encode_bit(w, &w->model->end, 1);
+        for (int i = 0; i < 5; i++)
+            shift_low(w);
+    } else {
+        put_uint32(trailer, (unsigned int) w->total);
+        if (w->count > 0)
+            write_bits(w, 0, 8 - w->count);
+        for (int i = 0; i < CODES_TRAILER_SIZE; i++)
+            write_bits(w, trailer[i], 8);
+    }
+    PHASE_PUSH(PHASE_WRITE);
+    fwrite(w->bytes, sizeof(unsigned char), w->position, w->file);
+    PHASE_POP();
+    w->position = 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void output_writing_file(Output *output, BitWriter *w)
+ *
+ * Una volta creato il codice ne eseguo la scrittura bufferizzata sul file compresso: l'indice con index_bits(global_index)
+ * bit seguito dal carattere successivo con 8 bit (scritti insieme, l'indice ha al massimo 24 bit).
+ * Con la codifica aritmetica (w->model) il codice è preceduto dal bit di fine dei codici, l'indice è codificato da
+ * encode_index e il carattere successivo con le probabilità scelte dal byte che lo precede (output->last).
+ *
+ */
+
+void output_writing_file(Output *output, BitWriter *w){
+    STATS_INC(stats.tokens);
+    if(output->index == 0) STATS_INC(stats.literals);
+    PHASE_PUSH(PHASE_ENCODE);
+    if (w->model != NULL) {
+        encode_bit(w, &w->model->end, 0);
+        encode_index(w, output->index);
+        encode_tree(w, w->model->value[output->last], output->next_value, 8);
+    } else {
+        write_bits(w, output->index << 8 | output->next_value, index_bits(global_index) + 8);
+    }
+    PHASE_POP();
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int output_reading_file(Output *output, BitReader *r)
+ *
+ * Lettura bufferizzata di un codice dal file compresso (stessa grandezza dell'indice usata da output_writing_file).
+ * Con la codifica aritmetica il byte che precede il carattere successivo è l'ultimo byte della frase dell'indice, o
+ * l'ultimo byte scritto se l'indice è 0 (un indice non valido viene restituito senza leggere il carattere).
+ *
+ * @return  1 -> se il codice è stato letto
+ *          0 -> se il file compresso è finito (r->error = 1 se è finito prima della fine dei codici)
+ *
+ */
+
+int output_reading_file(Output *output, BitReader *r){
+    unsigned int value;
+    int ok = 1;
+    PHASE_PUSH(PHASE_UNPACK);
+    if (r->model != NULL) {
+        Model *m = r->model;
+        if (decode_bit(r, &m->end) != 0 || r->missing != 0) {
+            r->error = r->missing != 0;
+            ok = 0;
+        } else {
+            output->index = decode_index(r, global_index);
+            if (output->index <= global_index) {
+                unsigned char last = output->index != 0 ? m->dictionary[output->index].value : m->last;
+                output->next_value = (unsigned char) decode_tree(r, m->value[last], 8);
+                m->last = output->next_value;
+            }
+        }
+    } else {
+        ok = read_bits(r, index_bits(global_index) + 8, &value);
+        if (ok) {
+            output->index = value >> 8;
+            output->next_value = (unsigned char) value;
+        }
+    }
+    PHASE_POP();
+    return ok;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t read_input_file(unsigned char buffer[], unsigned int buffer_size, FILE *input_file)
+ *
+ * Riempimento del buffer con i byte del file da comprimere (separato dal resto per misurarne il tempo di lettura)
+ *
+ * @return numero di byte letti
+ *
+ */
+
+size_t read_input_file(unsigned char buffer[], unsigned int buffer_size, FILE *input_file){
+    PHASE_PUSH(PHASE_READ);
+    size_t readed = fread(buffer, sizeof(unsigned char), buffer_size, input_file);
+    PHASE_POP();
+    return readed;
+}
+
+/***********************************************************************************************************************
+                                          INTESTAZIONE DEL FILE COMPRESSO
+ **********************************************************************************************************************/
+
+/*
+ * void put_uint32(unsigned char bytes[], unsigned int value)
+ * unsigned int get_uint32(const unsigned char bytes[])
+ *
+ * Scrittura e lettura di un numero a 4 byte in little endian
+ *
+ */
+
+static void put_uint32(unsigned char bytes[], unsigned int value){
+    for (int i = 0; i < 4; i++)
+        bytes[i] = (unsigned char) (value >> (8 * i));
+}
+
+static unsigned int get_uint32(const unsigned char bytes[]){
+    unsigned int value = 0;
+    for (int i = 3; i >= 0; i--)
+        value = value << 8 | bytes[i];
+    return value;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void write_stream_header(FILE *output_file, int mode, int policy)
+ *
+ * Scrittura dell'intestazione del file compresso: tutto quello che serve alla decompressione per usare lo stesso
+ * dizionario della compressione (numeri a più byte in little endian)
+ *
+ *      *************************************************************************************************************
+ *      *  "LZ78"  *  versione  *  mode  *  policy  *  bit indice  *  dictionary_size  *  block_size  *  coder  *
+ *      *  4 byte  *   1 byte   * 1 byte *  1 byte  *    1 byte    *      4 byte       *    4 byte    * 1 byte  *
+ *      *************************************************************************************************************
+ *
+ * bit indice è la grandezza massima degli indici, index_bits(dictionary_size), coder è la codifica dei codici
+ * (CODER_BITS: numero fisso di bit, CODER_RANGE: codifica aritmetica, vedi range_writer_init).
+ * Con block_size = 0 l'intestazione è seguita dai codici di tutto il file, altrimenti dai blocchi compressi
+ * indipendentemente (vedi compress_blocks).
+ *
+ */
+
+void write_stream_header(FILE *output_file, int mode, int policy){
+    unsigned char header[STREAM_HEADER_SIZE];
+
+    memcpy(header, LZ78_MAGIC, 4);
+    header[4] = LZ78_VERSION;
+    header[5] = (unsigned char) mode;
+    header[6] = (unsigned char) policy;
+    header[7] = (unsigned char) index_bits(dictionary_size);
+    put_uint32(&header[8], dictionary_size);
+    put_uint32(&header[12], block_size);
+    header[16] = (unsigned char) coder;
+    PHASE_PUSH(PHASE_WRITE);
+    fwrite(header, sizeof(unsigned char), STREAM_HEADER_SIZE, output_file);
+    PHASE_POP();
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int read_stream_header(FILE *input_file, int *mode, int *policy)
+ *
+ * Lettura e controllo dell'intestazione del file compresso (vedi write_stream_header), dictionary_size, block_size e coder
+ * vengono impostate con i valori letti
+ *
+ * @return 1 -> intestazione valida, 0 -> file troncato, di un'altra versione o con valori non validi
+ *
+ */
+
+int read_stream_header(FILE *input_file, int *mode, int *policy){
+    unsigned char header[STREAM_HEADER_SIZE];
+    unsigned int size, blocks;
+
+    PHASE_PUSH(PHASE_READ);
+    size_t readed = fread(header, sizeof(unsigned char), STREAM_HEADER_SIZE, input_file);
+    PHASE_POP();
+    if (readed != STREAM_HEADER_SIZE || memcmp(header, LZ78_MAGIC, 4) != 0 || header[4] != LZ78_VERSION)
+        return 0;
+    size = get_uint32(&header[8]);
+    blocks = get_uint32(&header[12]);
+    if (header[5] > MODE_LZAP || header[6] > POLICY_LRU || (header[5] == MODE_LZMW && header[6] == POLICY_LRU) ||
+        size < MIN_DICTIONARY_SIZE || size > MAX_DICTIONARY_SIZE || header[7] != index_bits(size) ||
+        blocks > MAX_BLOCK_SIZE || header[16] > CODER_RANGE)
+        return 0;
+    *mode = header[5];
+    *policy = header[6];
+    dictionary_size = size;
+    block_size = blocks;
+    coder = header[16];
+    return 1;
+}
+
+/***********************************************************************************************************************
+                                          COMPRESSIONE E DECOMPRESSIONE
+ **********************************************************************************************************************/
+
+/*
+ * void code_writing_file(unsigned int code, BitWriter *w)
+ * int code_reading_file(unsigned int *code, unsigned int last_index, BitReader *r)
+ *
+ * Scrittura e lettura bufferizzata di un codice LZW: solo l'indice, con index_bits(last_index) bit (con la codifica
+ * aritmetica il bit di fine dei codici e l'indice codificato da encode_index). Come output_reading_file la lettura
+ * restituisce 0 alla fine dei codici e imposta r->error se il file compresso è troncato.
+ *
+ */
+
+static void code_writing_file(unsigned int code, BitWriter *w){
+    STATS_INC(stats.tokens);
+    if(code < 256) STATS_INC(stats.literals);
+    PHASE_PUSH(PHASE_ENCODE);
+    if (w->model != NULL) {
+        encode_bit(w, &w->model->end, 0);
+        encode_index(w, code);
+    } else {
+        write_bits(w, code, index_bits(global_index));
+    }
+    PHASE_POP();
+}
+
+static int code_reading_file(unsigned int *code, unsigned int last_index, BitReader *r){
+    int ok = 1;
+    PHASE_PUSH(PHASE_UNPACK);
+    if (r->model != NULL) {
+        if (decode_bit(r, &r->model->end) != 0 || r->missing != 0) {
+            r->error = r->missing != 0;
+            ok = 0;
+        } else {
+            *code = decode_index(r, last_index);
+        }
+    } else {
+        ok = read_bits(r, index_bits(last_index), code);
+    }
+    PHASE_POP();
+    return ok;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void compress_lz78(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], FILE *input_file)
+ *
+ * Compressione LZ78: per ogni byte letto la frase corrente viene estesa se la frase estesa è nel dizionario,
+ * altrimenti viene scritto il codice (frase corrente, byte letto) e la frase estesa viene aggiunta al dizionario
+ * all'indice scelto da dictionary_add.
+ * Come per LZW la frase corrente continua anche tra un riempimento del buffer e il successivo, quindi i codici non
+ * dipendono dalla grandezza del buffer e la memoria usata è la stessa per file di qualsiasi grandezza.
+ *
+ */
+
+static void compress_lz78(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], FILE *input_file){
+    Output output;
+    size_t readed;                                          // byte letti nel buffer
+    unsigned long long bytes = 0;                           // byte compressi (per dictionary_add)
+    unsigned int node = 0, parent = 0, child;               // frase corrente (0 = frase vuota), suo prefisso e frase estesa con il byte letto
+    unsigned int length = 0;                                // lunghezza della frase corrente
+    unsigned char last = 0;                                 // ultimo byte della frase corrente
+    unsigned char previous = 0, before = 0;                 // ultimo byte letto e byte che lo precede (per la codifica aritmetica)
+    unsigned int index;
+
+    output.last = 0;
+    while((readed = read_input_file(buffer, (unsigned int) input_buffer_size, input_file)) > 0) {       // riempio buffer con i prossimi byte del file da comprimere
+        PHASE_PUSH(PHASE_SEARCH);
+        for (size_t i = 0; i < readed; i++) {
+            before = previous;
+            previous = buffer[i];
+            child = search_child(trie, node, buffer[i]);    // controllo se la frase corrente seguita dal byte letto è presente nel dizionario
+            if (child != 0) {                               // se è presente la frase corrente diventa la frase estesa
+                parent = node;
+                node = child;
+                last = buffer[i];
+                length++;
+                continue;
+            }
+            output.index = node;                            // altrimenti scrivo la codifica (frase corrente, byte letto)
+            output.next_value = buffer[i];
+            output.last = before;
+            output_writing_file(&output,writer);
+            bytes = bytes + length + 1;
+            STATS_ADD(stats.bytes, length + 1);
+            STATS_HIST(stats.phrase_hist, length + 1, STATS_PHRASE_SIZE);
+
+            index = dictionary_add(policy, trie, node, buffer[i], bytes, writer->total);
+            if (index != 0)
+                add_child(trie, node, buffer[i], index);    // aggiungo la frase estesa al dizionario
+            node = 0, length = 0;
+        }
+        PHASE_POP();
+    }
+    if (node != 0) {                                        // la frase alla fine del file è già nel dizionario: la scrivo come (prefisso, ultimo byte)
+        output.index = parent;
+        output.next_value = last;
+        output.last = before;
+        output_writing_file(&output,writer);
+        STATS_ADD(stats.bytes, length);
+        STATS_HIST(stats.phrase_hist, length, STATS_PHRASE_SIZE);
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void compress_lzw(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], FILE *input_file)
+ *
+ * Compressione LZW: il dizionario contiene già tutti i 256 byte (indici da 0 a 255), quindi ogni frase inizia con un
+ * byte già presente e viene scritto solamente l'indice della frase corrente. Il byte che interrompe la frase non viene
+ * scritto ma diventa l'inizio della frase successiva (il decompressore lo ricava dal codice successivo).
+ * La frase corrente continua anche tra un riempimento del buffer e il successivo.
+ *
+ */
+
+static void compress_lzw(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], FILE *input_file){
+    unsigned int node = 0, child;                           // frase corrente e frase estesa con il byte letto
+    unsigned int length = 0;                                // lunghezza della frase corrente (0 = nessuna frase)
+    unsigned long long bytes = 0;                           // byte compressi (per dictionary_add)
+    unsigned int index;
+    size_t readed;
+
+    while((readed = read_input_file(buffer, (unsigned int) input_buffer_size, input_file)) > 0) {
+        PHASE_PUSH(PHASE_SEARCH);
+        for (size_t i = 0; i < readed; i++) {
+            if (length == 0) {                              // la frase inizia con il byte letto (sempre nel dizionario)
+                node = buffer[i];
+                length = 1;
+                continue;
+            }
+            child = search_child(trie, node, buffer[i]);
+            if (child != 0) {
+                node = child;
+                length++;
+                continue;
+            }
+            code_writing_file(node, writer);                // scrivo l'indice della frase corrente
+            bytes = bytes + length;
+            STATS_ADD(stats.bytes, length);
+            STATS_HIST(stats.phrase_hist, length, STATS_PHRASE_SIZE);
+
+            index = dictionary_add(policy, trie, node, buffer[i], bytes, writer->total);
+            if (index != 0)
+                add_child(trie, node, buffer[i], index);    // aggiungo la frase estesa al dizionario
+            node = buffer[i], length = 1;                   // il byte letto è l'inizio della prossima frase
+        }
+        PHASE_POP();
+    }
+    if (length != 0) {                                      // ultima frase del file
+        code_writing_file(node, writer);
+        STATS_ADD(stats.bytes, length);
+        STATS_HIST(stats.phrase_hist, length, STATS_PHRASE_SIZE);
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int lzap_add(Policy *p, Trie *t, Entry d[], unsigned int previous, unsigned int previous_length, unsigned int current,
+ *              const unsigned char phrase[], unsigned int length, unsigned long long bytes, unsigned long long bits)
+ *
+ * Aggiunta delle frasi LZAP dopo ogni codice: la frase precedente seguita da ogni prefisso della frase corrente
+ * current (i suoi length byte sono in phrase), finchè le frasi sono lunghe al massimo MAX_PHRASE_LENGTH byte.
+ * Ogni frase è la frase aggiunta prima più un byte, quindi il dizionario rimane un trie e le frasi vengono aggiunte
+ * come in LZW: nel trie della compressione (t) o negli elementi della decompressione (d, con t = NULL), con le stesse
+ * chiamate a dictionary_add.
+ * La decompressione non ha il trie e non può sapere se una frase è già presente, quindi nemmeno la compressione lo
+ * controlla: se la frase precedente seguita dal primo byte è già nel dizionario (raro) le frasi vengono aggiunte lo
+ * stesso con indici nuovi (la stessa coppia nel trie più volte, la ricerca trova la prima).
+ *
+ * @return  1 -> la frase corrente può essere la frase precedente del prossimo codice
+ *          0 -> dizionario inizializzato o indice della frase corrente riusato da POLICY_LRU
+ *
+ */
+
+static int lzap_add(Policy *p, Trie *t, Entry d[], unsigned int previous, unsigned int previous_length,
+                    unsigned int current, const unsigned char phrase[], unsigned int length, unsigned long long bytes,
+                    unsigned long long bits){
+    unsigned int parent = previous, index;
+    int valid = 1;
+
+    for (unsigned int i = 0; i < length && previous_length + i < MAX_PHRASE_LENGTH; i++) {
+        index = dictionary_add(p, t, parent, phrase[i], bytes, bits);
+        if (index == 0) return valid && !p->reset;
+        if (index == current) valid = 0;
+        if (t != NULL)
+            add_child(t, parent, phrase[i], index);
+        else
+            add_element(d, index, parent, phrase[i]);
+        parent = index;
+    }
+    return valid;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void compress_lzap(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], unsigned char phrase[],
+ *                    FILE *input_file)
+ *
+ * Compressione LZAP: la ricerca della frase corrente è quella di LZW, ma il dizionario viene aggiornato solo quando la
+ * frase corrente è completa (dopo il suo codice), con la frase precedente seguita da ogni prefisso della frase corrente
+ * (vedi lzap_add). Il decompressore conosce già la frase di ogni codice letto, quindi non c'è il caso KwKwK di LZW.
+ * I byte della frase corrente vengono copiati in phrase (MAX_PHRASE_LENGTH byte, la lunghezza massima delle frasi).
+ *
+ */
+
+static void compress_lzap(Trie *trie, Policy *policy, BitWriter *writer, unsigned char buffer[], unsigned char phrase[],
+                          FILE *input_file){
+    unsigned int node = 0, child;                           // frase corrente e frase estesa con il byte letto
+    unsigned int length = 0;                                // lunghezza della frase corrente (0 = nessuna frase)
+    unsigned int previous = 0, previous_length = 0;         // frase precedente e sua lunghezza (0 = nessuna frase)
+    unsigned long long bytes = 0;                           // byte compressi (per dictionary_add)
+    int valid;
+    size_t readed;
+
+    while((readed = read_input_file(buffer, (unsigned int) input_buffer_size, input_file)) > 0) {
+        PHASE_PUSH(PHASE_SEARCH);
+        for (size_t i = 0; i < readed; i++) {
+            if (length == 0) {                              // la frase inizia con il byte letto (sempre nel dizionario)
+                node = buffer[i];
+                phrase[0] = buffer[i];
+                length = 1;
+                continue;
+            }
+            child = search_child(trie, node, buffer[i]);
+            if (child != 0) {
+                node = child;
+                phrase[length++] = buffer[i];
+                continue;
+            }
+            code_writing_file(node, writer);                // scrivo l'indice della frase corrente
+            bytes = bytes + length;
+            STATS_ADD(stats.bytes, length);
+            STATS_HIST(stats.phrase_hist, length, STATS_PHRASE_SIZE);
+
+            valid = previous_length == 0 ||
+                    lzap_add(policy, trie, NULL, previous, previous_length, node, phrase, length, bytes, writer->total);
+            previous = node, previous_length = valid ? length : 0;
+            node = buffer[i], phrase[0] = buffer[i], length = 1;        // il byte letto è l'inizio della prossima frase
+        }
+        PHASE_POP();
+    }
+    if (length != 0) {                                      // ultima frase del file
+        code_writing_file(node, writer);
+        STATS_ADD(stats.bytes, length);
+        STATS_HIST(stats.phrase_hist, length, STATS_PHRASE_SIZE);
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int lzmw_nodes(unsigned int dictionary_size)
+ *
+ * Nodi del trie della compressione LZMW oltre ai 256 byte: NODES_PER_PHRASE per elemento del dizionario, almeno quelli
+ * di 4 frasi lunghe MAX_PHRASE_LENGTH byte e al massimo quelli con un indice di 24 bit
+ *
+ */
+
+unsigned int lzmw_nodes(unsigned int dictionary_size){
+    unsigned long long nodes = (unsigned long long) dictionary_size * NODES_PER_PHRASE;
+    if (nodes < 4 * MAX_PHRASE_LENGTH) nodes = 4 * MAX_PHRASE_LENGTH;
+    if (nodes > MAX_DICTIONARY_SIZE - 255) nodes = MAX_DICTIONARY_SIZE - 255;
+    return (unsigned int) nodes;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t lzmw_bytes(unsigned int dictionary_size)
+ *
+ * Memoria usata da create_lzmw (da aggiungere alla grandezza della zona di memoria)
+ *
+ */
+
+size_t lzmw_bytes(unsigned int dictionary_size){
+    size_t n = (size_t) lzmw_nodes(dictionary_size) + 256;
+    return ARENA_BYTES(sizeof(Lzmw)) + trie_bytes((unsigned int) n) + 2 * ARENA_BYTES(n * sizeof(unsigned int)) +
+           ARENA_BYTES(n) + 2 * ARENA_BYTES(MAX_PHRASE_LENGTH + 1);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * Lzmw *create_lzmw(Arena *a, Policy *p, BitWriter *w)
+ *
+ * Creazione del dizionario della compressione LZMW.
+ * Le frasi LZMW non formano un trie (una frase viene aggiunta senza i suoi prefissi), quindi il trie contiene nodi
+ * invece di frasi: ogni frase e ogni suo prefisso è un nodo, e solo i nodi con un indice (phrase) sono frasi del
+ * dizionario. I nodi da 0 a 255 sono i byte (sempre frasi, con l'indice uguale al byte), gli altri nodi vengono
+ * numerati a partire da 256 nell'ordine di aggiunta e hanno un padre e un ultimo byte come gli elementi della
+ * decompressione.
+ *
+ * @return dizionario vuoto preso dalla zona di memoria a (NULL se non c'è abbastanza memoria, vedi lzmw_bytes)
+ *
+ */
+
+Lzmw *create_lzmw(Arena *a, Policy *p, BitWriter *w){
+    size_t n = (size_t) lzmw_nodes(dictionary_size) + 256;
+    Lzmw *m = arena_alloc(a, sizeof(Lzmw));                 // memoria azzerata: nessuna ricerca e nessuna frase precedente
+
+    if(m==NULL) return NULL;
+    m->trie = create_trie(a, (unsigned int) n);
+    m->parent = arena_alloc(a, n * sizeof(unsigned int));
+    m->phrase = arena_alloc(a, n * sizeof(unsigned int));
+    m->value = arena_alloc(a, n);
+    m->pending = arena_alloc(a, MAX_PHRASE_LENGTH + 1);
+    m->bytes = arena_alloc(a, MAX_PHRASE_LENGTH + 1);
+    if(m->trie==NULL || m->parent==NULL || m->phrase==NULL || m->value==NULL || m->pending==NULL || m->bytes==NULL)
+        return NULL;
+    for (unsigned int i = 0; i < 256; i++) {
+        m->phrase[i] = i;
+        m->value[i] = (unsigned char) i;
+    }
+    m->last_node = 255;
+    m->policy = p;
+    m->writer = w;
+    return m;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * unsigned int lzmw_add(Policy *p, Trie *t, unsigned int previous_length, unsigned int length,
+ *                       unsigned long long bytes, unsigned long long bits)
+ *
+ * Indice della frase LZMW (frase precedente di previous_length byte seguita dalla frase corrente di length byte),
+ * chiamata dopo ogni codice dalla compressione (t è il trie dei nodi) e dalla decompressione (t = NULL). Le frasi più
+ * lunghe di MAX_PHRASE_LENGTH byte non vengono aggiunte.
+ * Ogni frase aggiunge al trie della compressione al massimo length nodi: quando i nodi rimasti potrebbero non bastare
+ * alla frase successiva, questa è l'ultima frase (p->limit) e il dizionario viene gestito come pieno anche con meno
+ * di dictionary_size elementi. La decompressione fa lo stesso conto senza il trie.
+ *
+ * @return indice della nuova frase, 0 se la frase non va aggiunta (vedi dictionary_add)
+ *
+ */
+
+static unsigned int lzmw_add(Policy *p, Trie *t, unsigned int previous_length, unsigned int length,
+                             unsigned long long bytes, unsigned long long bits){
+    unsigned int index;
+
+    if (previous_length + length > MAX_PHRASE_LENGTH) {
+        p->reset = 0;
+        return 0;
+    }
+    if (global_index < p->limit && p->nodes + length + MAX_PHRASE_LENGTH > p->max_nodes)
+        p->limit = global_index + 1;
+    index = dictionary_add(p, t, 0, 0, bytes, bits);
+    if (index != 0) p->nodes = p->nodes + length;
+    return index;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void lzmw_write(Lzmw *m)
+ *
+ * Scrittura del codice della frase più lunga trovata dalla ricerca (m->match) e aggiunta della frase precedente
+ * seguita da questa frase: i nodi mancanti vengono aggiunti al trie a partire dal nodo della frase precedente e
+ * l'ultimo nodo diventa una frase. I byte cercati dopo la frase trovata (dal nodo raggiunto risalendo fino alla
+ * frase) vengono rimessi sulla pila dei byte da cercare.
+ *
+ */
+
+static void lzmw_write(Lzmw *m){
+    unsigned int node, child, index, i;
+
+    for (node = m->node; node != m->match; node = m->parent[node])     // il primo byte dopo la frase finisce in cima
+        m->pending[m->n_pending++] = m->value[node];
+    m->length = 0;
+
+    code_writing_file(m->phrase[m->match], m->writer);
+    m->total = m->total + m->match_length;
+    STATS_ADD(stats.bytes, m->match_length);
+    STATS_HIST(stats.phrase_hist, m->match_length, STATS_PHRASE_SIZE);
+
+    if (m->previous_length != 0) {
+        index = lzmw_add(m->policy, m->trie, m->previous_length, m->match_length, m->total, m->writer->total);
+        if (m->policy->reset) {                             // dizionario inizializzato: nessun nodo e nessuna frase precedente
+            m->last_node = 255;
+            m->previous_length = 0;
+            return;
+        }
+        if (index != 0) {
+            node = m->match;
+            for (i = m->match_length; i > 0; i--) {         // byte della frase trovata
+                m->bytes[i - 1] = m->value[node];
+                node = m->parent[node];
+            }
+            node = m->previous;
+            for (i = 0; i < m->match_length; i++) {
+                child = search_child(m->trie, node, m->bytes[i]);
+                if (child == 0) {
+                    child = ++m->last_node;
+                    add_child(m->trie, node, m->bytes[i], child);
+                    m->parent[child] = node;
+                    m->value[child] = m->bytes[i];
+                    m->phrase[child] = 0;
+                }
+                node = child;
+            }
+            m->phrase[node] = index;
+        }
+    }
+    m->previous = m->match;
+    m->previous_length = m->match_length;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void lzmw_search(Lzmw *m)
+ *
+ * Ricerca delle frasi nei byte della pila: la ricerca segue il trie dei nodi finchè può e ricorda l'ultimo nodo che è
+ * una frase (la frase più lunga), quando il trie non ha il byte successivo viene scritta la frase più lunga e la
+ * ricerca ricomincia dal byte dopo la frase (vedi lzmw_write). I nodi sono prefissi di frasi, quindi la pila contiene
+ * al massimo MAX_PHRASE_LENGTH + 1 byte.
+ *
+ */
+
+static void lzmw_search(Lzmw *m){
+    unsigned int child;
+    unsigned char value;
+
+    while (m->n_pending > 0) {
+        value = m->pending[--m->n_pending];
+        if (m->length == 0) {                               // la frase inizia con il byte (sempre nel dizionario)
+            m->node = m->match = value;
+            m->length = m->match_length = 1;
+            continue;
+        }
+        child = search_child(m->trie, m->node, value);
+        if (child != 0) {
+            m->node = child;
+            m->length++;
+            if (m->phrase[child] != 0) {
+                m->match = child;
+                m->match_length = m->length;
+            }
+            continue;
+        }
+        m->pending[m->n_pending++] = value;
+        lzmw_write(m);
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void compress_lzmw(Lzmw *m, unsigned char buffer[], FILE *input_file)
+ *
+ * Compressione LZMW: codici come LZW, ma dopo ogni codice viene aggiunta la frase precedente seguita dalla frase
+ * corrente, quindi le frasi possono raddoppiare di lunghezza ad ogni codice. Una frase non è per forza prefisso di
+ * un'altra frase, quindi la ricerca può andare oltre la frase più lunga e tornare indietro (vedi lzmw_search). La
+ * ricerca continua anche tra un riempimento del buffer e il successivo.
+ *
+ */
+
+static void compress_lzmw(Lzmw *m, unsigned char buffer[], FILE *input_file){
+    size_t readed;
+
+    while((readed = read_input_file(buffer, (unsigned int) input_buffer_size, input_file)) > 0) {
+        PHASE_PUSH(PHASE_SEARCH);
+        for (size_t i = 0; i < readed; i++) {
+            m->pending[m->n_pending++] = buffer[i];
+            lzmw_search(m);
+        }
+        PHASE_POP();
+    }
+    PHASE_PUSH(PHASE_SEARCH);
+    while (m->length != 0) {                                // ultime frasi del file
+        lzmw_write(m);
+        lzmw_search(m);
+    }
+    PHASE_POP();
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t compress_arena_bytes(int mode, int policy)
+ * size_t decompress_arena_bytes(int mode, int policy)
+ *
+ * Grandezza della zona di memoria di compress_stream e decompress_stream con dictionary_size elementi: dizionario,
+ * gestione del dizionario pieno e memoria della variante
+ *
+ */
+
+static size_t compress_arena_bytes(int mode, int policy){
+    size_t size = mode == MODE_LZMW ? lzmw_bytes(dictionary_size) : trie_bytes(dictionary_size) + ARENA_BYTES(MAX_PHRASE_LENGTH);
+    return size + policy_bytes(policy, dictionary_size);
+}
+
+static size_t decompress_arena_bytes(int mode, int policy){
+    size_t entries = (size_t) dictionary_size + 2;
+    size_t size = ARENA_BYTES(entries * sizeof(Entry)) + policy_bytes(policy, dictionary_size);
+    if (mode == MODE_LZMW)
+        size = size + ARENA_BYTES(entries * sizeof(unsigned int)) + ARENA_BYTES((MAX_PHRASE_LENGTH + 1) * sizeof(unsigned int));
+    return size;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int compress_stream(FILE *input_file, FILE *output_file, int mode, int policy)
+ *
+ * Compressione di tutti i byte di input_file con un solo dizionario: i codici scritti su output_file finiscono con
+ * l'ultimo byte completato da bit a 0
+ *
+ * @return  1 -> compressione eseguita
+ *          0 -> memoria insufficiente
+ *
+ */
+
+static int compress_stream(FILE *input_file, FILE *output_file, int mode, int policy){
+    unsigned char *buffer = malloc(input_buffer_size);      // usato per il riempimento del File da comprimere
+    BitWriter *writer = create_bit_writer();                // scrittura bufferizzata del File compresso
+    Model *model = coder == CODER_RANGE ? malloc(sizeof(Model)) : NULL;     // probabilità della codifica aritmetica
+    Arena *arena = arena_create(compress_arena_bytes(mode, policy));
+    Trie *trie = NULL;                                      // dizionario della compressione (trie delle frasi)
+    Lzmw *lzmw = NULL;                                      // dizionario della compressione LZMW (trie dei nodi)
+    unsigned char *phrase = NULL;                           // byte della frase corrente (LZAP)
+    Policy *full = NULL;                                    // gestione del dizionario pieno
+    int ok;
+
+    if (arena != NULL) {
+        full = create_policy(arena, policy, mode);
+        if (mode == MODE_LZMW) {
+            lzmw = create_lzmw(arena, full, writer);
+        } else {
+            trie = create_trie(arena, dictionary_size);
+            phrase = arena_alloc(arena, MAX_PHRASE_LENGTH);
+        }
+    }
+    ok = buffer!=NULL && writer!=NULL && full!=NULL && (lzmw!=NULL || (trie!=NULL && phrase!=NULL)) &&
+         (coder == CODER_BITS || model!=NULL);
+
+    if (ok) {
+        global_index = empty_index(mode);
+        bit_writer_init(writer, output_file);
+        if (model != NULL) range_writer_init(writer, model);
+        switch (mode) {
+            case MODE_LZW:
+                compress_lzw(trie, full, writer, buffer, input_file);
+                break;
+            case MODE_LZMW:
+                compress_lzmw(lzmw, buffer, input_file);
+                break;
+            case MODE_LZAP:
+                compress_lzap(trie, full, writer, buffer, phrase, input_file);
+                break;
+            default:
+                compress_lz78(trie, full, writer, buffer, input_file);
+        }
+        flush_bits(writer);                                 // scrivo gli ultimi bit sul file compresso
+    }
+
+    free(buffer);
+    free(writer);
+    free(model);
+    arena_free(arena);                                      // trie e gestione del dizionario pieno
+    return ok;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void write_long_phrase(Entry d[], unsigned int index, unsigned char decompressed[], FILE *output_file)
+ *
+ * Scrittura di una frase più lunga del buffer dei byte decompressi (buffer vuoto): la frase viene ricostruita a
+ * pezzi di output_buffer_size byte dall'inizio, per ogni pezzo si risale prima dall'ultimo byte della frase
+ * all'ultimo byte del pezzo. Succede solo con i dizionari di più di output_buffer_size elementi.
+ *
+ */
+
+static void write_long_phrase(Entry d[], unsigned int index, unsigned char decompressed[], FILE *output_file){
+    unsigned int length = d[index].length, written = 0, end, node, i;
+
+    while (written < length) {
+        end = length - written > output_buffer_size ? written + (unsigned int) output_buffer_size : length;
+        PHASE_PUSH(PHASE_COPY);
+        node = index;
+        for (i = length; i > end; i--)
+            node = d[node].parent;
+        for (i = end; i > written; i--) {
+            decompressed[i - written - 1] = d[node].value;
+            node = d[node].parent;
+        }
+        PHASE_POP();
+        PHASE_PUSH(PHASE_WRITE);
+        fwrite(decompressed, sizeof(unsigned char), end - written, output_file);
+        PHASE_POP();
+        written = end;
+    }
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void write_phrase(Entry d[], unsigned int index, unsigned char decompressed[], unsigned int *position, FILE *output_file)
+ *
+ * Scrittura della frase con indice index nel buffer dei byte decompressi: se la frase non ci sta i byte decompressi
+ * vengono prima scritti sul file (le frasi di qualsiasi byte e lunghezza, vedi write_long_phrase)
+ *
+ */
+
+static void write_phrase(Entry d[], unsigned int index, unsigned char decompressed[], unsigned int *position, FILE *output_file){
+    if (*position + d[index].length > output_buffer_size) {
+        PHASE_PUSH(PHASE_WRITE);
+        fwrite(decompressed, sizeof(unsigned char), *position, output_file);
+        PHASE_POP();
+        *position = 0;
+        if (d[index].length > output_buffer_size) {
+            write_long_phrase(d, index, decompressed, output_file);
+            return;
+        }
+    }
+    PHASE_PUSH(PHASE_COPY);
+    *position = *position + search_element_by_index(d, index, &decompressed[*position]);
+    PHASE_POP();
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_lz78(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file)
+ *
+ * Decompressione LZ78: ogni codice (indice, carattere successivo) è la frase del dizionario seguita dal carattere
+ * successivo, che diventa una nuova frase del dizionario. Se dictionary_add non aggiunge la frase, questa viene
+ * ricostruita nell'elemento di appoggio dictionary_size+1.
+ *
+ * @return 0 -> file compresso valido, 1 -> indice non presente nel dizionario
+ *
+ */
+
+static int decompress_lz78(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file){
+    Output output;
+    unsigned long long bytes = 0;                           // byte decompressi (per dictionary_add)
+    unsigned int index;
+
+    while (output_reading_file(&output, reader)) {          // leggo i codici fino alla fine del file compresso
+        if (output.index > global_index) return 1;          // l'indice non fa riferimento ad un elemento del dizionario
+        bytes = bytes + d[output.index].length + 1;
+        index = dictionary_add(policy, NULL, output.index, output.next_value, bytes, reader->total);
+        if (index == 0) index = dictionary_size + 1;
+        add_element(d, index, output.index, output.next_value);                         // aggiungo la nuova frase al dizionario
+        write_phrase(d, index, decompressed, position, output_file);                    // e la scrivo
+    }
+    return 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_lzw(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file)
+ *
+ * Decompressione LZW: il decompressore aggiunge la frase (frase precedente + primo byte della frase corrente) un codice
+ * dopo il compressore. L'indice della frase viene quindi scelto da dictionary_add prima di leggere il codice corrente
+ * (stessa grandezza degli indici del compressore) e la frase viene completata dopo, quando il primo byte è noto.
+ * L'indice letto può essere proprio quello della frase non ancora completata: succede con le sequenze del tipo KwKwK
+ * (la frase corrente è la frase precedente seguita dal suo primo byte), in questo caso il primo byte della frase
+ * corrente è il primo byte della frase precedente.
+ *
+ * @return 0 -> file compresso valido, 1 -> indice non presente nel dizionario
+ *
+ */
+
+static int decompress_lzw(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file){
+    unsigned int code, previous = 0, pending;
+    int has_previous = 0;                                   // 0 all'inizio e dopo ogni inizializzazione del dizionario
+    unsigned long long bytes = 0;                           // byte decompressi (per dictionary_add)
+
+    while (1) {
+        pending = 0;                                        // indice della frase da completare (0 = nessuna)
+        if (has_previous) {
+            pending = dictionary_add(policy, NULL, previous, 0, bytes, reader->total);
+            if (policy->reset) has_previous = 0;            // il compressore ha appena inizializzato il dizionario
+        }
+        if (!code_reading_file(&code, global_index, reader))
+            break;
+        if (code > global_index) return 1;
+        if (pending != 0) {
+            // primo byte della frase corrente (caso KwKwK: la frase corrente è quella che sto completando)
+            unsigned char first = code == pending ? d[previous].first : d[code].first;
+            add_element(d, pending, previous, first);
+        }
+        write_phrase(d, code, decompressed, position, output_file);
+        bytes = bytes + d[code].length;
+        previous = code, has_previous = 1;
+    }
+    return 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_lzmw(Entry d[], unsigned int second[], unsigned int stack[], Policy *policy, BitReader *reader,
+ *                     unsigned char decompressed[], unsigned int *position, FILE *output_file)
+ *
+ * Decompressione LZMW: ogni frase aggiunta è formata da due frasi già presenti, la frase precedente (d[].parent) e la
+ * frase corrente (second[]). La frase di un codice viene scritta espandendo le due frasi con una pila (stack, al
+ * massimo MAX_PHRASE_LENGTH indici: ogni indice sulla pila è almeno un byte della frase) fino alle frasi di un byte.
+ * Il dizionario viene aggiornato dopo ogni codice come nella compressione (vedi lzmw_add), la frase di ogni codice
+ * letto è quindi già nel dizionario.
+ *
+ * @return 0 -> file compresso valido, 1 -> indice non presente nel dizionario
+ *
+ */
+
+static int decompress_lzmw(Entry d[], unsigned int second[], unsigned int stack[], Policy *policy, BitReader *reader,
+                           unsigned char decompressed[], unsigned int *position, FILE *output_file){
+    unsigned int code, previous = 0, index, n;
+    int has_previous = 0, reset;                            // has_previous: 0 all'inizio e dopo ogni inizializzazione
+    unsigned long long bytes = 0;                           // byte decompressi (per lzmw_add)
+
+    while (code_reading_file(&code, global_index, reader)) {
+        if (code > global_index) return 1;
+        if (*position + d[code].length > output_buffer_size) {      // le frasi sono più corte del buffer
+            PHASE_PUSH(PHASE_WRITE);
+            fwrite(decompressed, sizeof(unsigned char), *position, output_file);
+            PHASE_POP();
+            *position = 0;
+        }
+        PHASE_PUSH(PHASE_COPY);
+        n = 0;
+        stack[n++] = code;
+        while (n > 0) {
+            index = stack[--n];
+            if (index < 256) {
+                decompressed[(*position)++] = d[index].value;
+            } else {
+                stack[n++] = second[index];                 // la frase precedente viene espansa per prima
+                stack[n++] = d[index].parent;
+            }
+        }
+        PHASE_POP();
+        bytes = bytes + d[code].length;
+
+        reset = 0;
+        if (has_previous) {
+            index = lzmw_add(policy, NULL, d[previous].length, d[code].length, bytes, reader->total);
+            reset = policy->reset;
+            if (index != 0) {
+                d[index].parent = previous;
+                d[index].length = d[previous].length + d[code].length;
+                second[index] = code;
+            }
+        }
+        previous = code, has_previous = !reset;
+    }
+    return 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_lzap(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file)
+ *
+ * Decompressione LZAP: la frase di ogni codice letto è già nel dizionario, dopo averla scritta vengono aggiunte le
+ * stesse frasi della compressione (vedi lzap_add) usando i byte appena scritti nel buffer (le frasi sono più corte
+ * del buffer, quindi la frase è tutta nel buffer).
+ *
+ * @return 0 -> file compresso valido, 1 -> indice non presente nel dizionario
+ *
+ */
+
+static int decompress_lzap(Entry d[], Policy *policy, BitReader *reader, unsigned char decompressed[], unsigned int *position, FILE *output_file){
+    unsigned int code, previous = 0, length;
+    int has_previous = 0;                                   // 0 all'inizio e dopo ogni inizializzazione del dizionario
+    unsigned long long bytes = 0;                           // byte decompressi (per dictionary_add)
+
+    while (code_reading_file(&code, global_index, reader)) {
+        if (code > global_index) return 1;
+        write_phrase(d, code, decompressed, position, output_file);
+        length = d[code].length;
+        bytes = bytes + length;
+        if (has_previous)
+            has_previous = lzap_add(policy, NULL, d, previous, d[previous].length, code,
+                                    &decompressed[*position - length], length, bytes, reader->total);
+        else
+            has_previous = 1;
+        previous = code;
+    }
+    return 0;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_stream(FILE *input_file, FILE *output_file, int mode, int policy)
+ *
+ * Decompressione dei codici scritti da compress_stream fino alla fine di input_file
+ *
+ * @return  0 -> decompressione eseguita
+ *          1 -> codici non validi, file compresso troncato o memoria insufficiente
+ *
+ */
+
+static int decompress_stream(FILE *input_file, FILE *output_file, int mode, int policy){
+    unsigned char *decompressed = malloc(output_buffer_size);           // byte decompressi non ancora scritti sul file
+    BitReader *reader = create_bit_reader();                            // lettura bufferizzata del File compresso
+    Model *model = coder == CODER_RANGE ? malloc(sizeof(Model)) : NULL; // probabilità della codifica aritmetica
+    Entry *dictionary = NULL;                                           // dizionario della decompressione (indice -> padre, byte) ed elemento di appoggio
+    unsigned int *second = NULL, *stack = NULL;                         // LZMW: seconda frase di ogni elemento e pila degli indici da espandere
+    Policy *full = NULL;                                                // gestione del dizionario pieno
+    Arena *arena = arena_create(decompress_arena_bytes(mode, policy));  // memoria del dizionario e della gestione del dizionario pieno
+    size_t entries = (size_t) dictionary_size + 2;
+    unsigned int position = 0;
+    int error = 1;
+
+    if (arena != NULL) {
+        dictionary = arena_alloc(arena, entries * sizeof(Entry));
+        full = create_policy(arena, policy, mode);
+        if (mode == MODE_LZMW) {
+            second = arena_alloc(arena, entries * sizeof(unsigned int));
+            stack = arena_alloc(arena, (MAX_PHRASE_LENGTH + 1) * sizeof(unsigned int));
+        }
+    }
+
+    if (decompressed!=NULL && reader!=NULL && dictionary!=NULL && full!=NULL && (mode != MODE_LZMW || (second!=NULL && stack!=NULL)) &&
+        (coder == CODER_BITS || model!=NULL)) {
+        inizialize_dictionary(dictionary, mode);
+        global_index = empty_index(mode);
+        bit_reader_init(reader, input_file);
+        if (model != NULL) {
+            range_reader_init(reader, model);
+            model->dictionary = dictionary;
+        }
+        switch (mode) {
+            case MODE_LZW:
+                error = decompress_lzw(dictionary, full, reader, decompressed, &position, output_file);
+                break;
+            case MODE_LZMW:
+                error = decompress_lzmw(dictionary, second, stack, full, reader, decompressed, &position, output_file);
+                break;
+            case MODE_LZAP:
+                error = decompress_lzap(dictionary, full, reader, decompressed, &position, output_file);
+                break;
+            default:
+                error = decompress_lz78(dictionary, full, reader, decompressed, &position, output_file);
+        }
+        if (reader->error) error = 1;                                   // il file è finito prima della fine dei codici
+        PHASE_PUSH(PHASE_WRITE);
+        fwrite(decompressed, sizeof(unsigned char), position, output_file);     // scrivo i byte decompressi rimasti
+        PHASE_POP();
+    }
+
+    free(decompressed);
+    free(reader);
+    free(model);
+    arena_free(arena);                                                  // dizionario e gestione del dizionario pieno
+    return error;
+}
+
+/***********************************************************************************************************************
+                                              COMPRESSIONE A BLOCCHI
+ **********************************************************************************************************************/
+
+/*
+ * void compress_block(Block *b)
+ * void decompress_block(Block *b)
+ *
+ * Compressione e decompressione di un blocco in memoria: i byte del blocco vengono letti e scritti come file in
+ * memoria (fmemopen e open_memstream), quindi il blocco passa dallo stesso codice della compressione di un file intero,
+ * con un dizionario nuovo.
+ *
+ */
+
+static void compress_block(Block *b){
+    FILE *input_file = fmemopen(b->raw, b->raw_size, "rb");
+    FILE *output_file = open_memstream((char **) &b->packed, &b->packed_size);
+
+    b->error = input_file == NULL || output_file == NULL;
+    if (!b->error)
+        b->error = !compress_stream(input_file, output_file, b->mode, b->policy);
+    if (input_file != NULL) fclose(input_file);
+    if (output_file != NULL) fclose(output_file);           // b->packed e b->packed_size aggiornati da fclose
+}
+
+static void decompress_block(Block *b){
+    size_t expected = b->raw_size;
+    FILE *input_file = fmemopen(b->packed, b->packed_size, "rb");
+    FILE *output_file = open_memstream((char **) &b->raw, &b->raw_size);
+
+    b->error = input_file == NULL || output_file == NULL;
+    if (!b->error)
+        b->error = decompress_stream(input_file, output_file, b->mode, b->policy);
+    if (input_file != NULL) fclose(input_file);
+    if (output_file != NULL) fclose(output_file);
+    if (b->raw_size != expected) b->error = 1;              // il blocco deve avere i byte scritti nella sua intestazione
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void *run_block(void *arg)
+ *
+ * Lavoro di un thread: compressione o decompressione di un blocco. Le statistiche del blocco vengono raccolte a parte
+ * (ogni thread ha le sue) e sommate da run_blocks.
+ *
+ */
+
+static void *run_block(void *arg){
+    Block *b = arg;
+#if LZ_STATS
+    Stats saved = stats;
+    memset(&stats, 0, sizeof(Stats));
+#endif
+    if (b->compress)
+        compress_block(b);
+    else
+        decompress_block(b);
+#if LZ_STATS
+    b->stats = stats;
+    stats = saved;
+#endif
+    return NULL;
+}
+
+/**********************************************************************************************************************/
+
+#if LZ_STATS
+/*
+ * void stats_add(Stats *total, const Stats *s)
+ *
+ * Somma delle statistiche di un blocco a quelle del thread chiamante
+ *
+ */
+
+static void stats_add(Stats *total, const Stats *s){
+    total->bytes += s->bytes;
+    total->tokens += s->tokens;
+    total->literals += s->literals;
+    total->searches += s->searches;
+    total->probes += s->probes;
+    total->resets += s->resets;
+    total->evictions += s->evictions;
+    for (int i = 0; i < STATS_PHRASE_SIZE; i++)
+        total->phrase_hist[i] += s->phrase_hist[i];
+}
+#endif
+
+/**********************************************************************************************************************/
+
+/*
+ * void run_blocks(Block blocks[], int n)
+ *
+ * Elaborazione di n blocchi (al massimo threads) in parallelo: un thread per blocco, il primo blocco viene elaborato
+ * dal thread chiamante. Ogni thread ha il suo global_index, quindi i blocchi non condividono niente. Se un thread non
+ * può essere creato il suo blocco viene elaborato dal thread chiamante.
+ *
+ */
+
+static void run_blocks(Block blocks[], int n){
+    pthread_t thread[MAX_THREADS];
+    int started[MAX_THREADS];
+
+    for (int i = 1; i < n; i++)
+        started[i] = pthread_create(&thread[i], NULL, run_block, &blocks[i]) == 0;
+    run_block(&blocks[0]);
+    for (int i = 1; i < n; i++) {
+        if (started[i]) pthread_join(thread[i], NULL);
+        else run_block(&blocks[i]);
+    }
+#if LZ_STATS
+    for (int i = 0; i < n; i++)
+        stats_add(&stats, &blocks[i].stats);
+#endif
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int compress_blocks(FILE *input_file, FILE *output_file, int mode, int policy)
+ *
+ * Compressione a blocchi: il file viene diviso in blocchi di block_size byte compressi indipendentemente, ognuno con
+ * il suo dizionario, threads blocchi alla volta. I blocchi vengono scritti in ordine, ognuno preceduto dalla sua
+ * intestazione:
+ *
+ *      ****************************************************************
+ *      *  byte originali  *  byte compressi  *  codici del blocco...  *
+ *      *      4 byte      *      4 byte      *                        *
+ *      ****************************************************************
+ *
+ * Le grandezze permettono alla decompressione di leggere i blocchi senza decomprimerli e di decomprimerli in
+ * parallelo. La memoria usata è di threads blocchi più i loro dizionari, per file di qualsiasi grandezza.
+ *
+ * @return  1 -> compressione eseguita
+ *          0 -> memoria insufficiente
+ *
+ */
+
+static int compress_blocks(FILE *input_file, FILE *output_file, int mode, int policy){
+    Block blocks[MAX_THREADS];
+    unsigned char header[BLOCK_HEADER_SIZE];
+    int ok = 1, n;
+
+    memset(blocks, 0, sizeof(blocks));
+    for (int i = 0; i < threads; i++) {
+        blocks[i].raw = malloc(block_size);
+        if (blocks[i].raw == NULL) ok = 0;
+    }
+
+    while (ok) {
+        for (n = 0; n < threads; n++) {                     // lettura dei prossimi blocchi
+            blocks[n].raw_size = read_input_file(blocks[n].raw, block_size, input_file);
+            if (blocks[n].raw_size == 0) break;
+            blocks[n].packed = NULL;
+            blocks[n].mode = mode;
+            blocks[n].policy = policy;
+            blocks[n].compress = 1;
+        }
+        if (n == 0) break;
+        run_blocks(blocks, n);
+        for (int i = 0; i < n; i++) {                       // scrittura dei blocchi compressi in ordine
+            if (blocks[i].error) ok = 0;
+            if (ok) {
+                put_uint32(&header[0], (unsigned int) blocks[i].raw_size);
+                put_uint32(&header[4], (unsigned int) blocks[i].packed_size);
+                PHASE_PUSH(PHASE_WRITE);
+                fwrite(header, sizeof(unsigned char), BLOCK_HEADER_SIZE, output_file);
+                fwrite(blocks[i].packed, sizeof(unsigned char), blocks[i].packed_size, output_file);
+                PHASE_POP();
+            }
+            free(blocks[i].packed);
+        }
+    }
+
+    for (int i = 0; i < threads; i++)
+        free(blocks[i].raw);
+    return ok;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int decompress_blocks(FILE *input_file, FILE *output_file, int mode, int policy)
+ *
+ * Decompressione a blocchi (vedi compress_blocks): vengono letti threads blocchi alla volta, decompressi in parallelo
+ * e scritti in ordine. Le intestazioni dei blocchi vengono controllate prima di allocare la memoria del blocco: al
+ * massimo block_size byte originali e al massimo LZ78_bound byte compressi (dipende dalla codifica dei codici).
+ *
+ * @return  0 -> decompressione eseguita
+ *          1 -> file compresso non valido o memoria insufficiente
+ *
+ */
+
+static int decompress_blocks(FILE *input_file, FILE *output_file, int mode, int policy){
+    Block blocks[MAX_THREADS];
+    unsigned char header[BLOCK_HEADER_SIZE];
+    int error = 0, n;
+    size_t readed;
+
+    while (!error) {
+        for (n = 0; n < threads; n++) {                     // lettura dei prossimi blocchi
+            PHASE_PUSH(PHASE_READ);
+            readed = fread(header, sizeof(unsigned char), BLOCK_HEADER_SIZE, input_file);
+            PHASE_POP();
+            if (readed == 0) break;                         // fine del file compresso
+            memset(&blocks[n], 0, sizeof(Block));
+            blocks[n].raw_size = get_uint32(&header[0]);
+            blocks[n].packed_size = get_uint32(&header[4]);
+            blocks[n].mode = mode;
+            blocks[n].policy = policy;
+            if (readed != BLOCK_HEADER_SIZE || blocks[n].raw_size == 0 || blocks[n].raw_size > block_size ||
+                blocks[n].packed_size > LZ78_bound(blocks[n].raw_size) ||
+                (blocks[n].packed = malloc(blocks[n].packed_size + 1)) == NULL) {
+                error = 1;
+                break;
+            }
+            PHASE_PUSH(PHASE_READ);
+            readed = fread(blocks[n].packed, sizeof(unsigned char), blocks[n].packed_size, input_file);
+            PHASE_POP();
+            if (readed != blocks[n].packed_size) {
+                free(blocks[n].packed);
+                error = 1;
+                break;
+            }
+        }
+        if (n == 0) break;
+        if (!error) run_blocks(blocks, n);
+        for (int i = 0; i < n; i++) {                       // scrittura dei blocchi decompressi in ordine
+            if (!error && blocks[i].error) error = 1;
+            if (!error) {
+                PHASE_PUSH(PHASE_WRITE);
+                fwrite(blocks[i].raw, sizeof(unsigned char), blocks[i].raw_size, output_file);
+                PHASE_POP();
+            }
+            free(blocks[i].packed);
+            free(blocks[i].raw);
+        }
+    }
+    return error;
+}
+
+/***********************************************************************************************************************
+                                              FUNZIONI PRINCIPALI
+ **********************************************************************************************************************/
+
+/*
+ * size_t memory_estimate(int compress, int mode, int policy)
+ *
+ * Stima della memoria usata dalla compressione (compress = 1) o dalla decompressione con i parametri attuali: buffer
+ * dei file, codifica aritmetica e dizionario di compress_stream o decompress_stream, per la compressione a blocchi
+ * moltiplicati per threads insieme al blocco originale e al blocco compresso (al massimo block_size byte ciascuno)
+ *
+ * @return byte
+ *
+ */
+
+size_t memory_estimate(int compress, int mode, int policy){
+    size_t size;
+
+    if (compress)
+        size = input_buffer_size + sizeof(BitWriter) + stream_buffer_size + compress_arena_bytes(mode, policy);
+    else
+        size = output_buffer_size + sizeof(BitReader) + stream_buffer_size + decompress_arena_bytes(mode, policy);
+    if (coder == CODER_RANGE)
+        size = size + sizeof(Model);
+    if (block_size == 0)
+        return size;
+    return (size_t) threads * (size + 2 * (size_t) block_size);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int fit_memory(int compress, int mode, int policy)
+ *
+ * Scelta dei parametri che rispettano il limite di memoria memory_limit (se diverso da 0), in ordine:
+ *
+ *  1. i buffer dei file diventano 1/16 del limite (tra MIN_IO_BUFFER_SIZE e la grandezza di default);
+ *  2. meno thread per la compressione e decompressione a blocchi;
+ *  3. solo compressione: blocchi più piccoli, dimezzati fino a MIN_BLOCK_SIZE;
+ *  4. solo compressione: dizionario più piccolo, dimezzato fino a MIN_DICTIONARY_SIZE; con LZMW solo finché il trie
+ *     dei nodi diminuisce (sotto il minimo di nodi un dizionario più piccolo toglie frasi senza risparmiare memoria).
+ *
+ * La decompressione non può cambiare il dizionario e i blocchi scritti nell'intestazione del file compresso, quindi
+ * un file compresso senza limite può richiedere più memoria del limite. memory_used riceve la stima finale (vedi
+ * memory_estimate).
+ *
+ * @return  1 -> la stima rispetta il limite
+ *          0 -> il limite è troppo piccolo (i parametri sono i più piccoli possibili)
+ *
+ */
+
+int fit_memory(int compress, int mode, int policy){
+    size_t io = memory_limit / 16;
+    unsigned int half;
+
+    if (memory_limit != 0) {
+        if (io < MIN_IO_BUFFER_SIZE) io = MIN_IO_BUFFER_SIZE;
+        input_buffer_size = io < BUFFER_SIZE ? io : BUFFER_SIZE;
+        output_buffer_size = io < OUTPUT_SIZE ? io : OUTPUT_SIZE;
+        stream_buffer_size = io < STREAM_BUFFER_SIZE ? io : STREAM_BUFFER_SIZE;
+        while (threads > 1 && memory_estimate(compress, mode, policy) > memory_limit)
+            threads--;
+        while (compress && block_size > MIN_BLOCK_SIZE && memory_estimate(compress, mode, policy) > memory_limit)
+            block_size = block_size / 2 > MIN_BLOCK_SIZE ? block_size / 2 : MIN_BLOCK_SIZE;
+        while (compress && dictionary_size > MIN_DICTIONARY_SIZE && memory_estimate(compress, mode, policy) > memory_limit) {
+            half = dictionary_size / 2 > MIN_DICTIONARY_SIZE ? dictionary_size / 2 : MIN_DICTIONARY_SIZE;
+            if (mode == MODE_LZMW && lzmw_nodes(half) == lzmw_nodes(dictionary_size))
+                break;                                      // il trie dei nodi non diminuisce più (vedi lzmw_nodes)
+            dictionary_size = half;
+        }
+    }
+    memory_used = memory_estimate(compress, mode, policy);
+    return memory_limit == 0 || memory_used <= memory_limit;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int LZ78_compressor(FILE *input_file, FILE *output_file, int mode, int policy)
+ *
+ * Compressione del file input_file nel file output_file con l'algoritmo LZ78 (mode = MODE_LZ78, codici
+ * (indice, carattere successivo)) o con la variante LZW (mode = MODE_LZW, solo indici). policy è la gestione del
+ * dizionario pieno (vedi create_policy), il dizionario ha dictionary_size elementi. Con block_size diverso da 0 il
+ * file viene compresso a blocchi indipendenti su threads thread (vedi compress_blocks). mode, policy,
+ * dictionary_size e block_size vengono scritti nell'intestazione del file compresso.
+ *
+ * @return  1 -> compressione eseguita
+ *          0 -> memoria insufficiente
+ *
+ */
+
+int LZ78_compressor(FILE *input_file, FILE *output_file, int mode, int policy){
+    write_stream_header(output_file, mode, policy);
+    if (block_size == 0)
+        return compress_stream(input_file, output_file, mode, policy);
+    return compress_blocks(input_file, output_file, mode, policy);
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * int LZ78_decompressor(FILE *input_file, FILE *output_file)
+ *
+ * Decompressione del file input_file nel file output_file: mode, policy, grandezza del dizionario e dei blocchi sono
+ * quelli letti dall'intestazione del file compresso, i blocchi vengono decompressi su threads thread (meno con il
+ * limite di memoria, vedi fit_memory)
+ *
+ * @return  0 -> decompressione eseguita
+ *          1 -> file compresso non valido o memoria insufficiente
+ *
+ */
+
+int LZ78_decompressor(FILE *input_file, FILE *output_file){
+    int mode, policy;
+
+    if (!read_stream_header(input_file, &mode, &policy))
+        return 1;
+    fit_memory(0, mode, policy);
+    if (block_size == 0)
+        return decompress_stream(input_file, output_file, mode, policy);
+    return decompress_blocks(input_file, output_file, mode, policy);
+}
+
+/***********************************************************************************************************************
+                                                CODEC IN MEMORIA
+ **********************************************************************************************************************/
+
+/*
+ * size_t LZ78_bound(size_t raw_size)
+ *
+ * Grandezza massima dei codici di raw_size byte: ogni codice copre almeno un byte e occupa al massimo 32 bit (indice a
+ * 24 bit e carattere successivo), con la codifica aritmetica al massimo 16 byte (18 bit con le probabilità, ognuno
+ * al massimo 6 bit, e 19 bit a 1/2), più gli ultimi byte scritti da flush_bits (con i codici a bit il numero di bit)
+ *
+ * @return byte
+ *
+ */
+
+size_t LZ78_bound(size_t raw_size){
+    return coder == CODER_RANGE ? 16 * raw_size + 16 : 4 * raw_size + 1 + CODES_TRAILER_SIZE;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * size_t LZ78_compress_buffer(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity)
+ * int LZ78_decompress_buffer(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size)
+ *
+ * Codec lz78_codec (vedi common/lz_codec.h): compressione e decompressione di un buffer in memoria come un blocco
+ * della compressione a blocchi (vedi compress_block), con variante codec_mode, gestione del dizionario pieno
+ * codec_policy, dictionary_size elementi e codifica coder. Nessuna intestazione viene scritta: chi usa il codec deve
+ * decomprimere con le stesse impostazioni.
+ *
+ * @return  LZ78_compress_buffer -> byte compressi, 0 se non stanno in capacity byte o se la memoria non è sufficiente
+ *          LZ78_decompress_buffer -> 0 decompressione eseguita, 1 buffer non valido o memoria insufficiente
+ *
+ */
+
+size_t LZ78_compress_buffer(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity){
+    Block b;
+    size_t result = 0;
+
+    memset(&b, 0, sizeof(Block));
+    b.raw = raw;
+    b.raw_size = raw_size;
+    b.mode = codec_mode;
+    b.policy = codec_policy;
+    b.compress = 1;
+    compress_block(&b);
+    if (!b.error && b.packed_size <= capacity) {
+        memcpy(packed, b.packed, b.packed_size);
+        result = b.packed_size;
+    }
+    free(b.packed);
+    return result;
+}
+
+int LZ78_decompress_buffer(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size){
+    Block b;
+
+    memset(&b, 0, sizeof(Block));
+    b.raw_size = raw_size;
+    b.packed = packed;
+    b.packed_size = packed_size;
+    b.mode = codec_mode;
+    b.policy = codec_policy;
+    decompress_block(&b);
+    if (!b.error)
+        memcpy(raw, b.raw, raw_size);
+    free(b.raw);
+    return b.error;
+}
+
+/**********************************************************************************************************************/
+
+/*
+ * void LZ78_write_params(FILE *file)
+ * int LZ78_read_params(FILE *file)
+ *
+ * Parametri del codec lz78_codec: l'intestazione del file compresso (vedi write_stream_header) con codec_mode,
+ * codec_policy, dictionary_size e coder, block_size deve essere 0 (i blocchi sono di chi usa il codec)
+ *
+ * @return 1 -> parametri validi, 0 -> parametri non validi
+ *
+ */
+
+void LZ78_write_params(FILE *file){
+    write_stream_header(file, codec_mode, codec_policy);
+}
+
+int LZ78_read_params(FILE *file){
+    return read_stream_header(file, &codec_mode, &codec_policy) && block_size == 0;
+}
+
+const LZCodec lz78_codec = { CODEC_LZ78, "lz78", LZ78_bound, LZ78_compress_buffer, LZ78_decompress_buffer,
+                             LZ78_write_params, LZ78_read_params };
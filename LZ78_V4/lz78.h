@@ -0,0 +1,299 @@
+/*
+ * Titolo: Algoritmo LZ78 (lz78.h)
+ *
+ * Corso: Algoritmi e strutture dati
+ * Autore: Elia Perrone
+ *
+ * Descrizione: definizioni, strutture e funzioni dell'algoritmo LZ78 (vedi lz78.c).
+ *              Il programma di compressione e decompressione si trova in main.c, i microbenchmark in bench/.
+ *              Il codec lz78_codec (vedi common/lz_codec.h) è usato dal programma LZ (vedi LZ/lz.c).
+ *
+ */
+
+#ifndef LZ78_H
+#define LZ78_H
+
+/*********************************************** LIBRERIE *************************************************************/
+
+#include <stdio.h>
+#include "../common/lz_timing.h"
+#include "../common/lz_stats.h"
+#include "../common/lz_codec.h"
+#include "../common/lz_pipeline.h"
+
+/************************************************ DEFINE **************************************************************/
+
+#define BUFFER_SIZE 1048576         // grandezza buffer d'inserimento del file da comprimere (1 MB, vedi input_buffer_size)
+#define OUTPUT_SIZE 1048576         // grandezza buffer dei byte decompressi (le frasi più lunghe vengono scritte a pezzi)
+#define DICTIONARY_SIZE 10000       // quantità di elementi nel dizionario di default (10000 elementi, vedi dictionary_size)
+#define MIN_DICTIONARY_SIZE 256     // quantità minima di elementi nel dizionario (LZW inizia con 256 elementi)
+#define MAX_DICTIONARY_SIZE 16777215    // quantità massima di elementi nel dizionario (indici a 24 bit)
+#define STREAM_BUFFER_SIZE 1048576  // grandezza buffer di byte della scrittura e lettura bufferizzata del file compresso
+#define MIN_IO_BUFFER_SIZE 8192     // grandezza minima dei tre buffer con il limite di memoria (frasi LZMW comprese)
+#define ARENA_ALIGN 64              // allineamento della memoria presa dalla zona di memoria del dizionario (una riga di cache)
+#define ARENA_BYTES(n) (((size_t) (n) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))    // byte occupati da n byte
+#define HUGE_PAGE_SIZE 2097152      // grandezza delle huge pages (2 MB, solo con -DLZ_HUGE_PAGES=1)
+#define MAX_GENERATION 255          // generazioni del dizionario della compressione prima di azzerare la tabella
+#define LZ78_MAGIC "LZ78"           // primi 4 byte del file compresso
+#define LZ78_VERSION 4              // versione del formato del file compresso
+#define STREAM_HEADER_SIZE 17       // byte dell'intestazione del file compresso (vedi write_stream_header)
+#define BLOCK_HEADER_SIZE 8         // byte dell'intestazione di un blocco (byte originali, byte compressi)
+#define CODES_TRAILER_SIZE 4        // byte dopo i codici a bit: bit dei codici scritti (vedi flush_bits)
+#define DEFAULT_BLOCK_SIZE 4194304  // grandezza dei blocchi con più thread se non indicata (4 MB)
+#define MAX_BLOCK_SIZE 1073741824   // grandezza massima dei blocchi (1 GB)
+#define MIN_BLOCK_SIZE 65536        // grandezza minima dei blocchi scelti dal limite di memoria (vedi fit_memory)
+#define MAX_THREADS 256             // thread massimi della compressione e decompressione a blocchi
+#define MODE_LZ78 0                 // codici (indice, carattere successivo)
+#define MODE_LZW 1                  // codici (indice), dizionario inizializzato con i 256 byte
+#define MODE_LZMW 2                 // come LZW, nuova frase = frase precedente + frase corrente
+#define MODE_LZAP 3                 // come LZW, nuove frasi = frase precedente + tutti i prefissi della frase corrente
+#define MAX_PHRASE_LENGTH 4096      // LZMW e LZAP: lunghezza massima delle frasi aggiunte al dizionario
+#define NODES_PER_PHRASE 16         // LZMW: nodi del trie della compressione per ogni elemento del dizionario
+#define POLICY_RESET 0              // dizionario pieno: inizializzazione (nuovo dizionario vuoto)
+#define POLICY_FREEZE 1             // dizionario pieno: nessuna nuova frase, quelle presenti continuano ad essere usate
+#define POLICY_MONITOR 2            // dizionario pieno: inizializzazione solo quando il rapporto di compressione peggiora
+#define POLICY_LRU 3                // dizionario pieno: la nuova frase prende il posto della frase foglia usata meno di recente
+#define CODER_BITS 0                // codici scritti con index_bits(global_index) bit per l'indice e 8 per il carattere
+#define CODER_RANGE 1               // codici scritti con la codifica aritmetica adattiva (vedi encode_bit)
+#define PROBABILITY_BITS 11         // precisione delle probabilità della codifica aritmetica
+#define PROBABILITY_SHIFT 5         // velocità di adattamento delle probabilità (1/32 della differenza per bit)
+#define RANGE_TOP 16777216          // range minimo della codifica aritmetica prima di scrivere un byte (2^24)
+#define INDEX_SLOTS 25              // numero di bit di un indice, da 0 a 24 (vedi encode_index)
+#define INDEX_MODEL_BITS 4          // bit dell'indice dopo il primo bit a 1 codificati con le probabilità, gli altri a 1/2
+#define RATIO_INTERVAL 10000        // byte elaborati tra due controlli del rapporto di compressione (POLICY_MONITOR)
+#define STATS_PHRASE_SIZE 65        // lunghezze delle frasi contate singolarmente nelle statistiche (l'ultima conta quelle >= 64)
+
+/**********************************************  STRUTTURE  ***********************************************************/
+
+// Struttura che rappresenta la codifica generata dall'algoritmo di compressione (indice,carattere successivo)
+typedef struct _output{
+    unsigned int index;                     // indice che fa riferimento ad un elemento all'interno del dizionario
+    unsigned char next_value;               // carattere successivo che interrompe la sequenza ricercata all'interno del dizionario
+    unsigned char last;                     // byte prima del carattere successivo (contesto della codifica aritmetica)
+}Output;
+
+// Struttura che rappresenta l'elemento all'interno del dizionario della decompressione (frase padre + ultimo byte)
+typedef struct _entry{
+    unsigned int parent;                    // indice della frase padre (0 = frase vuota)
+    unsigned int length;                    // lunghezza della frase
+    unsigned char value;                    // ultimo byte della frase
+    unsigned char first;                    // primo byte della frase (usato dalla decompressione LZW)
+}Entry;
+
+// Probabilità adattive della codifica aritmetica dei codici (vedi output_writing_file): probabilità a PROBABILITY_BITS bit
+// che il prossimo bit sia 0, per ogni posizione di un albero binario
+typedef struct _model{
+    unsigned short end;                                     // fine dei codici (un bit prima di ogni codice)
+    unsigned short slot[INDEX_SLOTS][32];                   // numero di bit dell'indice, per bit dell'ultimo indice
+    unsigned short high[INDEX_SLOTS][1 << INDEX_MODEL_BITS];    // bit dell'indice dopo il primo bit a 1, per numero di bit
+    unsigned short value[256][256];                         // carattere successivo (LZ78), per byte precedente
+    unsigned char last;                                     // decompressione: ultimo byte scritto
+    const Entry *dictionary;                                // decompressione: dizionario (ultimo byte delle frasi)
+}Model;
+
+// Scrittura bufferizzata del file compresso (vedi write_bits)
+typedef struct _bitwriter{
+    FILE *file;
+    unsigned long long bits;                    // bit non ancora scritti nel buffer di byte (i meno significativi)
+    unsigned int count;                         // numero di bit non ancora scritti
+    size_t position;                            // byte nel buffer
+    unsigned long long total;                   // bit scritti dall'inizio della compressione
+    Model *model;                               // codifica aritmetica (NULL = codici a bit, vedi range_writer_init)
+    unsigned long long low;                     // codifica aritmetica: inizio dell'intervallo (33 bit con il riporto)
+    unsigned int range;                         // ampiezza dell'intervallo
+    unsigned char cache;                        // ultimo byte non ancora scritto (può cambiare con il riporto)
+    unsigned long long cache_size;              // byte non ancora scritti: cache seguito da byte 0xFF
+    size_t capacity;                            // grandezza del buffer di byte (stream_buffer_size)
+    unsigned char bytes[];                      // buffer di byte scritto con fwrite
+}BitWriter;
+
+// Lettura bufferizzata del file compresso (vedi read_bits)
+typedef struct _bitreader{
+    FILE *file;
+    unsigned long long bits;                    // bit letti e non ancora usati (i meno significativi)
+    unsigned int count;                         // numero di bit non ancora usati
+    size_t position;                            // prossimo byte del buffer
+    size_t size;                                // byte nel buffer
+    unsigned long long total;                   // bit letti dall'inizio della decompressione
+    Model *model;                               // codifica aritmetica (NULL = codici a bit, vedi range_reader_init)
+    unsigned int range;                         // codifica aritmetica: ampiezza dell'intervallo
+    unsigned int code;                          // posizione nell'intervallo
+    unsigned int missing;                       // byte letti oltre la fine del file compresso
+    int error;                                  // 1 se il file compresso è finito prima della fine dei codici
+    size_t capacity;                            // grandezza del buffer di byte (stream_buffer_size)
+    unsigned char bytes[];                      // buffer di byte letto con fread
+}BitReader;
+
+// Zona di memoria contigua da cui vengono presi tutti gli elementi del dizionario (vedi arena_create)
+typedef struct _arena{
+    unsigned char *memory;                  // memoria azzerata
+    size_t size;                            // byte della zona di memoria
+    size_t used;                            // byte già assegnati
+    int mapped;                             // 1 se la memoria è stata presa con mmap (huge pages)
+}Arena;
+
+// Posizione della tabella hash del dizionario della compressione: frase (indice padre, byte successivo) -> indice
+typedef struct _slot{
+    unsigned int key;                       // (indice della frase padre << 8) | byte successivo
+    unsigned int index : 24;                // indice della frase estesa
+    unsigned int generation : 8;            // posizione occupata solo se uguale alla generazione del dizionario
+}Slot;
+
+// Dizionario della compressione: trie delle frasi memorizzato come tabella hash ad indirizzamento aperto (vedi lz78.c)
+typedef struct _trie{
+    Slot *slots;                            // posizioni della tabella (potenza di 2)
+    unsigned int mask;                      // numero di posizioni - 1
+    unsigned int shift;                     // 32 - log2(numero di posizioni), usato dalla funzione hash
+    unsigned int generation;                // generazione attuale (da 1 a MAX_GENERATION, 0 = posizione libera)
+}Trie;
+
+// Gestione del dizionario pieno, uguale nella compressione e nella decompressione (vedi dictionary_add)
+typedef struct _policy{
+    int type;                               // POLICY_RESET, POLICY_FREEZE, POLICY_MONITOR o POLICY_LRU
+    unsigned int base;                      // ultimo indice del dizionario vuoto (0 per LZ78, 255 per LZW)
+    int reset;                              // 1 se l'ultima chiamata a dictionary_add ha inizializzato il dizionario
+    unsigned long long reset_bytes;         // byte elaborati all'ultima inizializzazione (POLICY_MONITOR)
+    unsigned long long reset_bits;          // bit del file compresso all'ultima inizializzazione
+    unsigned long long checkpoint;          // byte elaborati al prossimo controllo del rapporto di compressione
+    unsigned long long best_bytes;          // rapporto di compressione dell'ultimo controllo (byte / bit)
+    unsigned long long best_bits;
+    unsigned int *parent;                   // per ogni indice: frase padre (POLICY_LRU)
+    unsigned char *value;                   // ultimo byte della frase
+    unsigned int *children;                 // numero di frasi figlie (le frasi senza figli sono foglie)
+    unsigned int *older;                    // lista delle foglie dalla meno recente alla più recente (0 = nessuna)
+    unsigned int *newer;
+    unsigned int oldest;                    // prima foglia da sostituire
+    unsigned int newest;
+    unsigned int limit;                     // elementi del dizionario pieno (dictionary_size, meno per LZMW)
+    unsigned int nodes;                     // LZMW: nodi del trie riservati dalle frasi aggiunte
+    unsigned int max_nodes;                 // LZMW: nodi disponibili (vedi lzmw_add)
+}Policy;
+
+// Compressione LZMW: nodi del trie (frasi e loro prefissi) e stato della ricerca della frase (vedi compress_lzmw)
+typedef struct _lzmw{
+    Trie *trie;                             // trie dei nodi: (nodo padre, byte) -> nodo, i nodi da 0 a 255 sono i byte
+    Policy *policy;
+    BitWriter *writer;
+    unsigned int *parent;                   // per ogni nodo: nodo padre
+    unsigned char *value;                   // ultimo byte del nodo
+    unsigned int *phrase;                   // indice della frase che finisce nel nodo (0 = solo prefisso di una frase)
+    unsigned int last_node;                 // ultimo nodo usato
+    unsigned char *pending;                 // byte da cercare di nuovo, il prossimo è in cima alla pila
+    unsigned int n_pending;
+    unsigned char *bytes;                   // byte della frase scritta (per la frase aggiunta al dizionario)
+    unsigned int node, length;              // nodo raggiunto dalla ricerca e sua lunghezza (0 = nessuna ricerca)
+    unsigned int match, match_length;       // ultimo nodo della ricerca che è una frase del dizionario
+    unsigned int previous, previous_length; // nodo della frase precedente (lunghezza 0 = nessuna frase precedente)
+    unsigned long long total;               // byte compressi (per dictionary_add)
+}Lzmw;
+
+// Struttura che raccoglie le statistiche della compressione (solo con -DLZ_STATS=1, vedi common/lz_stats.h)
+typedef struct _stats{
+    unsigned long long bytes;                               // byte compressi
+    unsigned long long tokens;                              // codifiche generate (indice,carattere successivo)
+    unsigned long long literals;                            // codifiche con indice 0 (carattere non presente nel dizionario)
+    unsigned long long searches;                            // chiamate a search_child
+    unsigned long long probes;                              // posizioni della tabella hash confrontate durante le ricerche
+    unsigned long long resets;                              // inizializzazioni del dizionario pieno
+    unsigned long long evictions;                           // frasi sostituite nel dizionario pieno (POLICY_LRU)
+    unsigned long long phrase_hist[STATS_PHRASE_SIZE];      // istogramma delle lunghezze delle frasi (carattere successivo compreso)
+}Stats;
+
+// Blocco della compressione e decompressione a blocchi: lavoro di un thread (vedi run_blocks)
+typedef struct _block{
+    unsigned char *raw;                     // byte originali
+    size_t raw_size;
+    unsigned char *packed;                  // byte compressi (codici del blocco)
+    size_t packed_size;
+    int mode;
+    int policy;
+    int compress;                           // 1 compressione, 0 decompressione
+    int error;                              // 1 se il blocco non è stato compresso o decompresso
+#if LZ_STATS
+    Stats stats;                            // statistiche del blocco
+#endif
+}Block;
+
+/********************************************* VARIABILI GLOBALI ******************************************************/
+
+// indice generale per l'aggiunta di un elemento nel dizionario (uno per ogni thread)
+extern LZ_THREAD_LOCAL unsigned int global_index;
+
+// quantità di elementi nel dizionario (da MIN_DICTIONARY_SIZE a MAX_DICTIONARY_SIZE)
+extern unsigned int dictionary_size;
+
+// grandezza dei blocchi compressi indipendentemente (0 = un solo blocco, vedi compress_blocks)
+extern unsigned int block_size;
+
+// thread usati dalla compressione e decompressione a blocchi
+extern int threads;
+
+// codifica dei codici: CODER_BITS o CODER_RANGE
+extern int coder;
+
+// variante e gestione del dizionario pieno del codec lz78_codec
+extern int codec_mode;
+extern int codec_policy;
+
+// grandezza dei buffer del file da comprimere, dei byte decompressi e del file compresso (BUFFER_SIZE, OUTPUT_SIZE e
+// STREAM_BUFFER_SIZE, meno con il limite di memoria)
+extern size_t input_buffer_size;
+extern size_t output_buffer_size;
+extern size_t stream_buffer_size;
+
+// limite di memoria del codec (0 = senza limite) e memoria stimata dell'ultima chiamata a fit_memory
+extern size_t memory_limit;
+extern size_t memory_used;
+
+#if LZ_STATS
+// statistiche della compressione (una copia per ogni thread, vedi run_blocks)
+extern LZ_THREAD_LOCAL Stats stats;
+#endif
+
+/************************************************* FUNZIONI ***********************************************************/
+
+void inizialize_dictionary(Entry d[], int mode);
+void add_element(Entry d[], unsigned int index, unsigned int parent, unsigned char value);
+unsigned int search_element_by_index(Entry d[], unsigned int index, unsigned char value[]);
+Arena *arena_create(size_t size);
+void *arena_alloc(Arena *a, size_t bytes);
+void arena_free(Arena *a);
+size_t trie_bytes(unsigned int dictionary_size);
+Trie *create_trie(Arena *a, unsigned int dictionary_size);
+void inizialize_trie(Trie *t);
+unsigned int search_child(Trie *t, unsigned int parent, unsigned char value);
+void add_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index);
+void remove_child(Trie *t, unsigned int parent, unsigned char value, unsigned int index);
+size_t policy_bytes(int type, unsigned int dictionary_size);
+Policy *create_policy(Arena *a, int type, int mode);
+unsigned int lzmw_nodes(unsigned int dictionary_size);
+size_t lzmw_bytes(unsigned int dictionary_size);
+Lzmw *create_lzmw(Arena *a, Policy *p, BitWriter *w);
+unsigned int dictionary_add(Policy *p, Trie *t, unsigned int parent, unsigned char value, unsigned long long bytes,
+                            unsigned long long bits);
+unsigned int index_bits(unsigned int last_index);
+BitWriter *create_bit_writer(void);
+BitReader *create_bit_reader(void);
+void bit_writer_init(BitWriter *w, FILE *file);
+void write_bits(BitWriter *w, unsigned int value, unsigned int n);
+void flush_bits(BitWriter *w);
+void bit_reader_init(BitReader *r, FILE *file);
+int read_bits(BitReader *r, unsigned int n, unsigned int *value);
+void range_writer_init(BitWriter *w, Model *m);
+void range_reader_init(BitReader *r, Model *m);
+void output_writing_file(Output *output, BitWriter *w);
+int output_reading_file(Output *output, BitReader *r);
+size_t read_input_file(unsigned char buffer[], unsigned int buffer_size, FILE *input_file);
+void write_stream_header(FILE *output_file, int mode, int policy);
+int read_stream_header(FILE *input_file, int *mode, int *policy);
+size_t memory_estimate(int compress, int mode, int policy);
+int fit_memory(int compress, int mode, int policy);
+int LZ78_compressor(FILE *input_file, FILE *output_file, int mode, int policy);
+int LZ78_decompressor(FILE *input_file, FILE *output_file);
+size_t LZ78_bound(size_t raw_size);
+size_t LZ78_compress_buffer(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity);
+int LZ78_decompress_buffer(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size);
+void LZ78_write_params(FILE *file);
+int LZ78_read_params(FILE *file);
+
+#endif
@@ -1,70 +1,30 @@
 /*
- * Titolo: Algoritmo LZ78
+ * Titolo: Algoritmo LZ78 (main.c)
  *
  * Corso: Algoritmi e strutture dati
  * Autore: Elia Perrone
  * Classe: I2A
  *
- * Descrizione: Progetto inerente gli algoritmi di compressione
- * Inizio:  18.09.2017
- * Fine:    19.01.2018
- *
- *
- * Descrizione:
- * LZ78 è un'algoritmo di compressione che abbandona il concetto di scorrimento della finestra, utilizzato nell'algorit-
- * mo LZ77, e che implementa l'ideaologia di compressione sui dati futuri, e non sui dati già passati.
- * Inoltre, LZ78 deve implementare la gestione di un dizionario.
- * Di volta in volta, scorrendo l'intero file da comprimere, l'algoritmo LZ78 ricerca all'interno del suo dizionario,
- * stringhe composte da sottostringhe, dove quest'ultime sono seguite da un carattere che rompe la sequenza di matching.
- * Fattore importante di questo algoritmo, in confronto con l'LZ77, è che non abbiamo una restrizione su quando indietro
- * puo essere ricercato un match. Data la gestione di un dizionario possiamo affermare che, se una stringa è memoriz-
- * zata nel dizionario allora lo è anche un suo prefisso.
- * Inoltre, il dizionario alla fine della compressione non viene inviato dunque, grazie alla flessibilità dell'algorit-
- * mo possiamo ricostruirlo passo a passo durante la decompressione in maniera automatica.
- *
- *
- * Pseudo-codice:
- *
- *   1:  begin
- *   2:     initialize a dictionary by empty phrase P
- *   3:     while (not EOF) do
- *   4:      begin
- *   5:        readSymbol(X)
- *   6:        if (F.X> is in the dictionary) then
- *   7:           F = F.X
- *   8:        else
- *   9:         begin
- *  10:           output(pointer(F),X)
- *  11:           encode X to the dictionary
- *  12:           initialize phrase F by empty character
- *  13:         end
- *  14:        end
- *  15:     end
- *
- *
- * Scrittura bufferizzata:
- *
- *      **************************             Per ogni indice dell'elemento del dizionario conosco la grandezza, ovvero
- *      *   INDICE   *     bit   *             quanti bit occurrono, per rappresentarlo.
- *      **************************             La scrittura bufferizzata mi permette di usufruire di una grandezza
- *      *      1      *    1     *             variabile dell'indice in maniera tale da poter risparmiare bit da scrivere
- *      *      2      *    2     *             sul file compresso.
- *      *      3      *    2     *
- *      *      4      *    3     *
- *      *      5      *    3     *             Al contrario durante la decompressine saprò che grandezza ha l'indice
- *      *     ...     *   ...    *             dell'elemento da aggiungere nel dizionario dunque potro estrarre facil-
- *      *      n      * log2(n)  *             mente le codifiche dal file compresso.
- *      **************************
- *
- *
- * Implementazioni mancanti:    1. scrittura bufferizzata per la compressione
- *                              2. lettura bufferizzata per la decompressione
- *                              3. gestione del programma tramite comandi da terminale
- *
- *
- * Problemi nel codice:         1. compressione: strutture dati non efficienti
- *                              2. decompressione: gestire gli indici con lettura bufferizzata
- *
+ * Descrizione: programma da riga di comando per la compressione e la decompressione LZ78 (l'algoritmo si trova in
+ *              lz78.c)
+ *
+ *  ./LZ78_V3 -c [opzioni] inputfile outputfile                          --> compressione
+ *  ./LZ78_V3 -d [-t thread] [--mem-limit byte] inputfile outputfile     --> decompressione
+ *
+ *  Opzioni della compressione (la decompressione le legge dall'intestazione del file compresso):
+ *
+ *  -m lz78|lzw|lzmw|lzap           variante dell'algoritmo (default lz78)
+ *  -p reset|freeze|monitor|lru     gestione del dizionario pieno (default reset, vedi create_policy in lz78.c, lru non
+ *                                  disponibile con lzmw)
+ *  -s elementi                     elementi del dizionario, da 256 a 16777215 (default 10000)
+ *  -b bit                          grandezza massima degli indici, da 9 a 24 bit (dizionario di 2^bit - 1 elementi)
+ *  -t thread                       thread usati, da 1 a 256 (default 1, anche per la decompressione a blocchi)
+ *  -B megabyte                     compressione a blocchi indipendenti di B MB, da 1 a 1024 (default 4 con -t, senza
+ *                                  -t e -B il file è un unico blocco)
+ *  -e bits|range                   codifica dei codici: numero fisso di bit o codifica aritmetica adattiva (default bits)
+ *  --mem-limit byte                limite di memoria, con i suffissi K, M e G (vedi common/lz_memory.h): i buffer, i
+ *                                  thread, i blocchi e il dizionario vengono ridotti fino a rispettarlo (vedi
+ *                                  fit_memory in lz78.c), la decompressione riduce solo i buffer e i thread
  */
 
 /*********************************************** LIBRERIE *************************************************************/
@@ -72,422 +32,254 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
-#include <time.h>
-
-/************************************************ DEFINE **************************************************************/
-
-#define VALUE_SIZE 100              // grandezza valore all'interno del dizionario (100 byte max)
-#define BUFFER_SIZE 1000            // grandezza buffer d'inserimento del file da comprimere (1000 byte max)
-#define DICTIONARY_SIZE 10000       // quantità di elementi nel dizionario (10000 elementi)
-#define BITBUFFER_SIZE 16           // grandezza in bit dei campi dell'output (fisso 16 bit max) (grandezza usata senza scrittura bufferizzata)
-#define WINDOW_SIZE 10              // finestra di ricerca valore (grandezza della sottostringa ricercata) (10 byte max)
-
-/**********************************************  STRUTTURE  ***********************************************************/
+#include "lz78.h"
+#include "../common/lz_memory.h"
 
-// Struttura che rappresenta la codifica generata dall'algoritmo di compressione (indice,carattere successivo)
-typedef struct _output{
-    unsigned int index;                     // indice che fa riferimento ad un elemento all'interno del dizionario
-    unsigned char next_value;               // carattere successivo che interrompe la sequenza ricercata all'interno del dizionario
-}Output;
-
-// Struttura che rappresenta l'elemento all'interno del dizionario (indice,valore)
-typedef struct _element{
-    unsigned int index;                     // indice di riferimento di un elemento all'interno del dizionario
-    unsigned char value[VALUE_SIZE];        // valore dell'elemento nel dizionario
-}Element;
-
-/********************************************* VARIABILI GLOBALI ******************************************************/
-
-// indice generale per l'aggiunta di un elemento nel dizionario
-unsigned int global_index = 0;
-
-// variabile utilizzata per la conversione decimale - binaria
-unsigned int bit = 0;
-
-/***********************************************************************************************************************
-                                                  FUNZIONI
-***********************************************************************************************************************/
+static const char *mode_names[] = { "lz78", "lzw", "lzmw", "lzap" };
+static const char *policy_names[] = { "reset", "freeze", "monitor", "lru" };
+static const char *coder_names[] = { "bits", "range" };
 
 /*
- * void inizialize_dictionary(Element d[], unsigned int dictionary_size, unsigned int value_size)
+ * int find_name(const char *names[], int n, const char *name)
  *
- * Inizializzazione del dizionario (tutti i campi sono settati al valore nullo del tipo di dato corrispondente)
+ * Posizione di name nella lista names di n nomi
  *
- */
-
-void inizialize_dictionary(Element d[], unsigned int dictionary_size, unsigned int value_size){
-    for (int i = 0; i < dictionary_size; i++) {
-        d[i].index=0;
-        for (int j = 0; j < value_size; j++) {
-            d[i].value[j] = '\0';
-        }
-    }
-}
-
-/**********************************************************************************************************************/
-
-/*
- * void inizialize_buffer(unsigned char v[], unsigned int buffer_size)
- *
- * Inizializzazione di un buffer:
- * utilizzo di buffer all'interno della compressione che della decompressione (popolamento con file o sottostrighe)
+ * @return posizione, -1 se il nome non è nella lista
  *
  */
 
-void inizialize_buffer(unsigned char v[], unsigned int buffer_size){
-    for (int i = 0; i < buffer_size; ++i) {
-        v[i] = '\0';
+int find_name(const char *names[], int n, const char *name){
+    for (int i = 0; i < n; i++) {
+        if (!strcmp(names[i], name)) return i;
     }
+    return -1;
 }
 
 /**********************************************************************************************************************/
 
 /*
- * void add_element(Element d[], unsigned int global_index, unsigned char value[], unsigned int value_size)
- *
- * Aggiunta di un'elemento nel dizionario:
+ * void file_size(FILE *input_file, FILE *output_file)
  *
- * Tramite un indice globale gestisco l'aggiunta di elementi all'interno del dizionario.
- * Ogni volta che viene riscontrata una sequenza non presente nel dizionario essa viene aggiunta.
+ * Stampa della grandezza del file da comprimere e del file compresso
  *
  */
 
-void add_element(Element d[], unsigned int global_index, unsigned char value[], unsigned int value_size){
-    d[global_index].index = global_index+1;
-    for (int i = 0; i < value_size; i++) {
-        d[global_index].value[i] = value[i];
-    }
+void file_size(FILE *input_file, FILE *output_file){
+    fseek(input_file, 0L, SEEK_END);
+    printf("\nInput file size: %ld\n", ftell(input_file));
+    fseek(output_file, 0L, SEEK_END);
+    printf("Output file size: %ld\n", ftell(output_file));
 }
 
 /**********************************************************************************************************************/
 
 /*
- * unsigned int search_element_by_value(Element d[], unsigned char value[], unsigned int dictionary_size, unsigned int value_size)
- *
- * Ricercare la presenza di un elemento all'interno del dizionario avendo a disposizione il suo valore
+ * void stats_report(int mode, int policy)
  *
- * @return  0 -> se non è stato trovato nessun elemento corrispodennte al valore richiesto
- *          n -> dove n è il valore dell'indice dell'elemento nel dizionario corrispondente al valore richiesto
+ * Scrittura in formato JSON delle statistiche raccolte durante la compressione (solo con -DLZ_STATS=1)
  *
  */
 
-unsigned int search_element_by_value(Element d[], unsigned char value[], unsigned int dictionary_size, unsigned int value_size){
-    unsigned int index=0,count=0;
-    for (int i = 0; i < dictionary_size; i++) {
-        for (int j = 0; j < value_size; j++) {
-            if(d[i].value[j]==value[j]) {           // incremento un contatore se ogni posizione dell'array contenente il
-                count++;                            // valore dell'elemento nel dizionario corrisponde con il valore richiesto
-            }
-            else{
-                count=0;                            // in caso contrario resetto il contatore
-                break;
-            }
-        }
-        if(count==value_size){                      // se l'intero valore dell'elemento del dizionario corrisponde con
-            index = d[i].index;                     // il valore richiesto allora estraggo l'indice dell'elemento
-        }
-    }
-    return index;                                   // ritorno l'indice dell'elemento (0 se non è stato trovato)
+void stats_report(int mode, int policy){
+#if LZ_STATS
+    FILE *out = stats_open();
+    fprintf(out, "{\"codec\":\"%s\",\"dictionary_size\":%u,", mode_names[mode], dictionary_size);
+    fprintf(out, "\"policy\":\"%s\",\"coder\":\"%s\",", policy_names[policy], coder_names[coder]);
+    fprintf(out, "\"bytes\":%llu,\"tokens\":%llu,\"literals\":%llu,", stats.bytes, stats.tokens, stats.literals);
+    fprintf(out, "\"literal_ratio\":%f,", stats.tokens ? (double) stats.literals / (double) stats.tokens : 0.0);
+    fprintf(out, "\"bytes_per_token\":%f,", stats.tokens ? (double) stats.bytes / (double) stats.tokens : 0.0);
+    fprintf(out, "\"searches\":%llu,\"probes\":%llu,", stats.searches, stats.probes);
+    fprintf(out, "\"probes_per_position\":%f,", stats.bytes ? (double) stats.probes / (double) stats.bytes : 0.0);
+    fprintf(out, "\"dictionary_resets\":%llu,\"evictions\":%llu,", stats.resets, stats.evictions);
+    stats_json_histogram(out, "phrase_length", stats.phrase_hist, STATS_PHRASE_SIZE);
+    fprintf(out, "}\n");
+    stats_close(out);
+#else
+    (void) mode;
+    (void) policy;
+#endif
 }
 
 /**********************************************************************************************************************/
 
 /*
- * void search_element_by_index(Element d[], unsigned int index, unsigned char value[], unsigned int dictionary_size, unsigned int value_size)
- *
- * Ricercare la presenta di un elemento all'interno del dizionario avendo a disposizione il suo indice
- * Una volta trovata la corrispondenza dell'indice nel dizionario la funzione mi associa il valore estratto dall'elemento del
- * dizionario ad un valore (array di char)
+ * int close_streams(FILE *input, FILE *input_file, FILE *output, FILE *output_file)
  *
- */
-
-// Ricerca la presenza di un elemento all'interno del dizionario avendo a disposizione il suo indice
-void search_element_by_index(Element d[], unsigned int index, unsigned char value[], unsigned int dictionary_size, unsigned int value_size){
-    for (int i = 0; i < dictionary_size; i++) {
-        if(d[i].index==index) {
-            for (int j = 0; j < value_size; j++) {
-                value[j]=d[i].value[j];
-            }
-        }
-    }
-}
-
-/***********************************************************************************************************************
-                                               SCRITTURA SU FILE
- **********************************************************************************************************************/
-
-/*
- * void fill_buffer(unsigned int buffer[], unsigned int value, unsigned int buffer_size)
- *
- * Riempimento di un buffer con grandezza variabile (BUFFER_SIZE)
- *
- */
-
-void fill_buffer(unsigned int buffer[], unsigned int value, unsigned int buffer_size){
-    if(bit<buffer_size){
-        buffer[bit] = value;
-    } else {
-        bit=0;
-    }
-    bit++;
-}
-
-/**********************************************************************************************************************/
-
-/*
- * void decimal_binary(unsigned int decimal, unsigned int buffer[], unsigned int buffer_size)
+ * Chiusura degli stream della pipeline, i file restano aperti (vedi common/lz_pipeline.h)
  *
- * Conversione di un valore da decimale a binario (valore inserito all'interno di un buffer)
+ * @return 0, 1 se c'è stato un errore di lettura o di scrittura
  *
  */
 
-void decimal_binary(unsigned int decimal, unsigned int buffer[], unsigned int buffer_size) {
-    for (int i = buffer_size-1; i >= 0; i--) {
-        if(decimal >= ((int)pow(2,i))){
-            fill_buffer(buffer,1,BITBUFFER_SIZE);
-            decimal = decimal-((int)pow(2,i));
-        } else {
-            fill_buffer(buffer,0,BITBUFFER_SIZE);
-        }
-    }
-}
-
-/**********************************************************************************************************************/
-
-/*
- * unsigned int binary_decimal(unsigned int buffer[], unsigned int buffer_size)
- *
- * Conversione di un valore da binaria a decimale (valore inserito in una variabile)
- *
- * @return decimal
- *
- */
+int close_streams(FILE *input, FILE *input_file, FILE *output, FILE *output_file){
+    int error = pipe_close(input, input_file) != 0;
 
-unsigned int binary_decimal(unsigned int buffer[], unsigned int buffer_size){
-    unsigned int decimal=0;
-    for(int i=0; i<buffer_size; i++){
-        decimal = decimal+buffer[BITBUFFER_SIZE-1-i]*((int)pow(2,i));
-    }
-    return decimal;
+    if (pipe_close(output, output_file) != 0) error = 1;
+    if (error) printf("Errore nella lettura o nella scrittura dei file\n");
+    return error;
 }
 
 /**********************************************************************************************************************/
 
 /*
- * void output_writing_file(Output *output, unsigned char buffer[], FILE *output_file)
- *
- * Una volta creato il codice ne eseguo una scrittura sul file compresso
- *
- */
-
-void output_writing_file(Output *output, unsigned char buffer[], FILE *output_file){
-    unsigned char bits_value='\0';
-    decimal_binary(output->index,buffer,BITBUFFER_SIZE);
-    bits_value = binary_decimal(buffer,BITBUFFER_SIZE);
-    fprintf(output_file, "%d", bits_value);
-    bits_value='\0';
-    decimal_binary(output->next_value, buffer,BITBUFFER_SIZE);
-    bits_value = binary_decimal(buffer,BITBUFFER_SIZE);
-    fprintf(output_file, "%c", bits_value);
-}
-
-/***********************************************************************************************************************
-Attenzione: Le 4 funzioni riportate in questa sezione (scrittura bufferizzata) andrebbero migliorate implementando il
-            sistema di bufferizzazione argomentato all'inizio del file (metodo degli indici).
-***********************************************************************************************************************/
-
-/*
- * void append(unsigned char s[], unsigned char c)
+ * void usage(const char *program)
  *
- * Concatenazione di un char alla fine di una stringa (utilizzata per la decompressione)
+ * Stampa delle istruzioni del programma
  *
  */
 
-void append(unsigned char s[], unsigned char c) {
-    int len = strlen(s);
-    s[len] = c;
-    s[len+1] = '\0';
+void usage(const char *program){
+    printf("Usage: %s -c [-m lz78|lzw|lzmw|lzap] [-p reset|freeze|monitor|lru] [-s entries | -b bits] [-t threads] "
+           "[-B megabytes] [-e bits|range] [--mem-limit bytes] inputfile outputfile\n", program);
+    printf("       %s -d [-t threads] [--mem-limit bytes] inputfile outputfile\n", program);
 }
 
-/**********************************************************************************************************************/
-
-/*
- * void cleaning_memory(Element d[])
- *
- * Cancellazione del dizionario (da eseguire a fine compressio)
- */
-
-void cleaning_memory(Element d[]){
-    inizialize_dictionary(d,DICTIONARY_SIZE,VALUE_SIZE);
-}
 
 /***********************************************************************************************************************
                                                     MAIN
 ***********************************************************************************************************************/
 
-int main() {
-
-/***************************************** VARIABILI PER LA COMPRESSIONE  *********************************************/
+int main(int argc, char *argv[]) {
 
     // File
-    FILE *input_file;       // File da comprimere
-    FILE *output_file;      // File compresso
-    FILE *output2_file;     // File decompresso (uguale al File da comprimere)
-
-    // Buffer
-    unsigned char buffer[BUFFER_SIZE];          // usato per il riempimento del File da comprimere
-    inizialize_buffer(buffer,BUFFER_SIZE);
-    unsigned char subbuffer[BUFFER_SIZE];       // usato per la ricerca di valori dell'input all'interno del dizionario
-    unsigned int bitbuffer[BITBUFFER_SIZE];     // usato per la grandezza dell'output sul File compresso
-
-    // Oggetti
-    Output *output = malloc(sizeof(Output));                            // elemento output (... , ...)
-    Element dictionary[DICTIONARY_SIZE];                                // elemento dizionario (... = ...)
-    inizialize_dictionary(dictionary,DICTIONARY_SIZE,VALUE_SIZE);
-
-/************************************************ COMPRESSIONE ********************************************************/
-
-    // Inizio algoritmo di compressione
-    printf("\n");
-    printf("COMPRESSIONE -> ");
-
-    // Inizio calcolo tempo di compressione
-    clock_t begin = clock();
-
-    // Apertura del file da comprimere (va inserito il percorso del file che si vuole comprimere)
-    input_file = fopen("percorso file da comprimere", "rb");
-    if(input_file==NULL) printf("Errore nell'apertura del file input");
-
-    // Apertura del file compresso (va inserito il percorso del file compresso che verrà generato dalla compressione)
-    output_file = fopen("percorso del file compresso", "wb");
-    if(output_file==NULL) printf("Errore nell'apertura del file output");
-
-
-    // Algoritmo di compressione
-    while(fread(buffer, sizeof(unsigned char), BUFFER_SIZE, input_file)) {          // riempio buffer con i primi 1000 byte del file da comprimere
-        unsigned int i = 0, j = 1;                                                  // i e j sono due variabili per muovermi all'interno dei buffer
-        while(buffer[i]!='\0') {                                                    // finchè non mi trovo alla fine del buffer
-            inizialize_buffer(subbuffer,BUFFER_SIZE);
-            memcpy(subbuffer, &buffer[i], j);                                                           // inserisco una sottostringa di buffer in subbuffer
-            if (search_element_by_value(dictionary,subbuffer,DICTIONARY_SIZE,VALUE_SIZE) != 0) {        // controllo se la sottostringa è presente nel dizionario
-                j++;                                                                                    // se è presente incremente j (aumento la sottostringa in subbuffer)
-            } else {
-                add_element(dictionary,global_index,subbuffer,VALUE_SIZE);                              // aggiungo il valore ricercato all'intenro di un nuovo elemento del dizionario
-                global_index++;
-                if(global_index==DICTIONARY_SIZE) {                                         // se ho raggiunto 10000 elementi all'interno del dizionario lo inizializzo e parto con un nuovo dizionario (aumenta la velocità di compressione)
-                    global_index=0;
-                    inizialize_dictionary(dictionary,DICTIONARY_SIZE,VALUE_SIZE);
-                }
-                j--;
-                if (j == 0) {                               // se è un carattere nuovo j = 0
-                    output->index = 0;
-                    output->next_value = buffer[i];
-                    output_writing_file(output,bitbuffer,output_file);      // scrivo al codifica ottenuta nel file compresso
-                    i++, j = 1;                                             // aggionro gli indici di spostamento dei buffer
-                } else {
-                    inizialize_buffer(subbuffer,WINDOW_SIZE);
-                    memcpy(subbuffer, &buffer[i], j);                                                                   // torno alla sottostringa ricercata precedentemente
-                    output->index = search_element_by_value(dictionary,subbuffer,DICTIONARY_SIZE,VALUE_SIZE);
-                    output->next_value = buffer[i + j];
-                    output_writing_file(output,bitbuffer,output_file);                                                  // scrivo al codifica ottenuta nel file compresso
-                    i = i + j + 1, j = 1;                                                                               // aggionro gli indici di spostamento dei buffer
-                }
+    FILE *input_file;       // File da comprimere o da decomprimere
+    FILE *output_file;      // File compresso o decompresso
+    FILE *input, *output;   // stream della pipeline sui due file (vedi common/lz_pipeline.h)
+
+    // Opzioni della compressione
+    int mode = MODE_LZ78;           // variante dell'algoritmo: MODE_LZ78 (indice, carattere successivo), MODE_LZW, MODE_LZMW o MODE_LZAP (solo indici)
+    int policy = POLICY_RESET;      // gestione del dizionario pieno
+    long size = DICTIONARY_SIZE;    // elementi del dizionario
+    long n_threads = 1;             // thread della compressione e decompressione a blocchi
+    long block_mb = 0;              // grandezza dei blocchi in MB (0 = file intero)
+    size_t limit = 0;               // limite di memoria (0 = senza limite)
+    int compress;
+    int error = 0;
+    int i;
+
+    if (argc < 4 || (strcmp(argv[1], "-c") && strcmp(argv[1], "-d"))) {
+        usage(argv[0]);
+        return 1;
+    }
+    compress = !strcmp(argv[1], "-c");
+
+    // Lettura delle opzioni (solo -t e --mem-limit per la decompressione)
+    for (i = 2; i < argc - 2; i++) {
+        if ((!compress && strcmp(argv[i], "-t") && strcmp(argv[i], "--mem-limit")) || i + 1 >= argc - 2) {
+            printf("!WARNING! Wrong option (%s)\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+        if (!strcmp(argv[i], "-m")) {
+            mode = find_name(mode_names, 4, argv[++i]);
+        } else if (!strcmp(argv[i], "-p")) {
+            policy = find_name(policy_names, 4, argv[++i]);
+        } else if (!strcmp(argv[i], "-s")) {
+            size = atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-b")) {
+            long bits = atol(argv[++i]);
+            size = bits >= 9 && bits <= 24 ? (1L << bits) - 1 : 0;
+        } else if (!strcmp(argv[i], "-t")) {
+            n_threads = atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-e")) {
+            coder = find_name(coder_names, 2, argv[++i]);
+        } else if (!strcmp(argv[i], "-B")) {
+            block_mb = atol(argv[++i]);
+            if (block_mb == 0) block_mb = -1;
+        } else if (!strcmp(argv[i], "--mem-limit")) {
+            if ((limit = mem_parse(argv[++i])) == 0) {
+                printf("!WARNING! Wrong value (%s) for option %s, must be at least %dK\n", argv[i], argv[i - 1],
+                       MEM_MIN_LIMIT >> 10);
+                return 1;
             }
+        } else {
+            printf("!WARNING! Wrong option (%s)\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+        if (mode < 0 || policy < 0 || coder < 0 || size < MIN_DICTIONARY_SIZE || size > MAX_DICTIONARY_SIZE ||
+            n_threads < 1 || n_threads > MAX_THREADS || block_mb < 0 || block_mb > MAX_BLOCK_SIZE >> 20) {
+            printf("!WARNING! Wrong value (%s) for option %s\n", argv[i], argv[i - 1]);
+            return 1;
         }
     }
-    fclose(input_file);         // chiudo il file da comprimere
-    fclose(output_file);        // chiudo il file compresso
-
-    // Cancellazione dizionario
-    cleaning_memory(dictionary);
-    global_index=0;
-
-    // Fine calcolo del tempo di compressione
-    clock_t end = clock();
-    printf("Execution Time:  ");
-    printf("%f", ((double) (end - begin) / CLOCKS_PER_SEC));
-    printf(" [seconds]\n ");
-
-/***********************************************************************************************************************
-Attenzione: La compressione allo stato attuale è funzionante solamente per i file di testo (questo perchè vengono utili-
-            zzate funzioni che possono essere eseguite unicamente su stringhe (string.h)).
-            Inoltre modificando le grandezze delle strutture (dizionario e buffer prevalentemente) la compressione non
-            funziona perchè gli array non accedono correttamente alle posizoini richieste. Questo problema è dato sop-
-            rattuto dal tipo di strutture utilizzata (non efficienti per un algoritmo di questo genere).
-            Un passo successivo sarebbe sicuramente implementare una struttura ad albero in maniera tale da poter gesti-
-            re in maniera piu ottimale le varie grandezze in gioco e soprattutto per migliore i tempi di compressione.
-***********************************************************************************************************************/
+    if (mode == MODE_LZMW && policy == POLICY_LRU) {
+        printf("!WARNING! Policy lru is not available with lzmw\n");
+        return 1;
+    }
+    dictionary_size = (unsigned int) size;
+    threads = (int) n_threads;
+    if (block_mb > 0)
+        block_size = (unsigned int) block_mb << 20;
+    else if (threads > 1)
+        block_size = DEFAULT_BLOCK_SIZE;
+
+    // Limite di memoria: la pipeline riceve al massimo un quarto del limite, il codec il resto (vedi fit_memory)
+    if (limit > 0)
+        memory_limit = mem_split(limit);
+    if (compress && !fit_memory(1, mode, policy))
+        printf("!WARNING! Memory limit too small, estimated %zu KB\n", memory_used >> 10);
+
+    input_file = fopen(argv[argc - 2], "rb");
+    if (input_file == NULL) {
+        printf("!WARNING! Input file doesn't exists!\n");
+        return 1;
+    }
+    output_file = fopen(argv[argc - 1], "wb");
+    if (output_file == NULL) {
+        printf("!WARNING! Output file can't be created!\n");
+        fclose(input_file);
+        return 1;
+    }
 
-/****************************************** VARIABILI PER LA DECOMPRESSIONE  ******************************************/
+    // Inizio calcolo tempo (tempo reale, vedi common/lz_timing.h)
+    timing_start();
 
-    // Buffer
-    unsigned char debuffer[BUFFER_SIZE];            // usato per il riempimento del File da decomprimere
-    inizialize_buffer(debuffer,BUFFER_SIZE);
-    unsigned char next_char_value[VALUE_SIZE];      // usato per l'inserimento del carattere successivo
-    unsigned char value[VALUE_SIZE];                // usato per l'inserimento del valore del dizionario
+    // Lettura e scrittura dei file su thread separati dal codec
+    input = pipe_open_reader(input_file);
+    output = pipe_open_writer(output_file);
 
-    unsigned int index_value,k=0;
+    if (compress) {
+/************************************************ COMPRESSIONE ********************************************************/
 
+        printf("\nCOMPRESSIONE (%s, %s, %s, %u elementi", mode_names[mode], policy_names[policy], coder_names[coder],
+               dictionary_size);
+        if (block_size != 0)
+            printf(", blocchi di %u KB, %d thread", block_size >> 10, threads);
+        if (limit > 0)
+            printf(", memoria stimata %zu KB", memory_used >> 10);
+        printf(") -> ");
+        if (!LZ78_compressor(input, output, mode, policy)) {
+            printf("Errore nell'allocazione del dizionario\n");
+            error = 1;
+        }
+        error |= close_streams(input, input_file, output, output_file);
+        timing_stop();
+        timing_report(stdout);
+        timing_export("lz78", "compress");
+        stats_report(mode, policy);
+        file_size(input_file, output_file);
+    } else {
 /************************************************* DECOMPRESSIONE *****************************************************/
 
-    printf("\n");
-    printf("DECOMPRESSIONE -> ");
-
-    // Inizio calcolo tempo di decompressione
-    clock_t begin2 = clock();
-
-    // Apertura del file da decomprimere (va inserito il percorso del file che si vuole decomprimere)
-    output_file = fopen("percorso file da decomprimere", "rb");
-    if(output_file==NULL) printf("Errore nell'apertura del file output");
-
-    // Apertura del file decompresso (va inserito il percorso del file decompresso che verrà generato dalla decompressione)
-    output2_file = fopen("percorso file decompresso", "wb");
-    if(output2_file==NULL) printf("Errore nell'apertura del file");
-
-    // Algoritmo di decompressione
-    while (k<BUFFER_SIZE) {
-        debuffer[k] = (unsigned char) fgetc(output_file);   // popolo il debuffer con i codici da decodificare
-        k++;
-    }
-    unsigned int i=0,j=0;
-    for (int l = 0; l < k; l++) {
-        inizialize_buffer(value,VALUE_SIZE);
-        inizialize_buffer(next_char_value,VALUE_SIZE);
-        index_value = debuffer[i];                          // estraggo l'indice
-        next_char_value[j] = debuffer[i + 1];               // estraggo il carattere successivo
-        if (index_value == '0') {                                                                       // se l'indice è 0
-            add_element(dictionary, global_index, next_char_value,VALUE_SIZE);                          // aggiungo il carattere successivo al dizionario
-            global_index++;
-            fputc(debuffer[i + 1], output2_file);           // scrivo il carattere successivo sul file
-            i = i + 2;                                      // aggiorno gli indici
-        } else {
-            search_element_by_index(dictionary, index_value-'0', value,DICTIONARY_SIZE,VALUE_SIZE);             // ricerco il valore all'interno del dizionario tramite l'indice
-            append(value, next_char_value[j]);                                                                  // concateno il valore del dizionario con il carattere successivo
-            add_element(dictionary, global_index, value,VALUE_SIZE);                                            // aggiungo l'occorenza al dizionario
-            global_index++;
-            fwrite(value, sizeof(unsigned char), VALUE_SIZE, output2_file);         // scrivo su file il valore del dizionario + il carattere successivo
-            i = i + 2;                                                              // aggiorno gli indici
+        printf("\nDECOMPRESSIONE -> ");
+        if (LZ78_decompressor(input, output)) {
+            printf("Errore: file compresso non valido\n");
+            error = 1;
         }
+        if (limit > 0)
+            printf("\nMemoria stimata: %zu KB (limite del codec %zu KB)\n", memory_used >> 10, memory_limit >> 10);
+        if (limit > 0 && memory_used > memory_limit)
+            printf("!WARNING! Memory limit too small for the dictionary and blocks of this file\n");
+        error |= close_streams(input, input_file, output, output_file);
+        timing_stop();
+        timing_report(stdout);
+        timing_export("lz78", "decompress");
     }
-    fclose(output_file);    // chiudo il file da decomprimere
-    fclose(output2_file);   // chiudo il file decompresso
-
-    // Fine calcolo tempo di decompressione
-    clock_t end2 = clock();
-    printf("Execution Time:  ");
-    printf("%f", ((double) (end2 - begin2) / CLOCKS_PER_SEC));
-    printf(" [seconds]\n ");
 
-    free(output);       // libero la memoria occupata dalla codifica
-
-/***********************************************************************************************************************
-Attenzione: La decompressione allo stato attuale è funzionanete solo per gli indici degli elementi del diziona-
-            rio minori di 10, questo perchè non viene gestita la lunghezza dell'indice (l'idea era di implementare la
-            lettura bufferizzata ma data l'assenza della scrittura bufferizzata non è stato possibile implementarla).
-***********************************************************************************************************************/
-
-    return 0;
+    fclose(input_file);     // chiudo il file letto
+    fclose(output_file);    // chiudo il file scritto
+    return error;
 }
 
-/**********************************************************************************************************************/
\ No newline at end of file
+/**********************************************************************************************************************/
@@ -0,0 +1,177 @@
+/***********************************************************************************************************************
+ *
+ *  bench.c
+ *
+ *  Generazione dei dati sintetici, misurazione e stampa dei risultati dei microbenchmark (vedi bench.h).
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../common/lz_timing.h"
+
+#define MAX_REPETITIONS 1000
+
+const char *bench_input_names[N_INPUTS] = { "random", "text", "repetitive", "zeros" };
+
+int bench_repetitions = 11;
+size_t bench_size = 65536;
+volatile unsigned long bench_sink = 0;
+
+static const char *bench_filter = NULL;
+static const char *bench_codec = "";
+
+static const char *words[] = {
+    "il", "la", "di", "e", "che", "un", "per", "non", "in", "con", "the", "of", "and", "to", "a", "is",
+    "compressione", "dizionario", "finestra", "sequenza", "buffer", "algoritmo", "codifica", "file",
+    "lunghezza", "offset", "carattere", "byte", "window", "lookahead", "index", "value"
+};
+
+/*
+ * Generatore pseudo-casuale xorshift64: veloce e deterministico (stesso seme -> stessi dati su ogni macchina)
+ */
+static unsigned long long bench_random(unsigned long long *state){
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/***********************************************************************************************************************
+ * void bench_parse_args(int, char *[])
+ *
+ * Lettura delle opzioni da riga di comando (vedi bench.h).
+ */
+void bench_parse_args(int argc, char *argv[]){
+    for(int i=1; i<argc; i++){
+        if(!strcmp(argv[i], "-r") && i+1 < argc){
+            bench_repetitions = atoi(argv[++i]);
+        } else if(!strcmp(argv[i], "-s") && i+1 < argc){
+            bench_size = (size_t) atol(argv[++i]);
+        } else {
+            bench_filter = argv[i];
+        }
+    }
+    if(bench_repetitions < 1)
+        bench_repetitions = 1;
+    if(bench_repetitions > MAX_REPETITIONS)
+        bench_repetitions = MAX_REPETITIONS;
+    if(bench_size < 1024)
+        bench_size = 1024;
+}
+
+int bench_selected(const char *kernel){
+    return bench_filter == NULL || strstr(kernel, bench_filter) != NULL;
+}
+
+/***********************************************************************************************************************
+ * void bench_fill(unsigned char *, size_t, enum bench_input)
+ *
+ * Riempimento di un buffer con i dati sintetici del tipo richiesto.
+ */
+void bench_fill(unsigned char *buffer, size_t size, enum bench_input input){
+    unsigned long long state = 0x9E3779B97F4A7C15ULL + (unsigned long long) input;
+    unsigned char pattern[100];
+    size_t i = 0;
+
+    switch(input){
+        case INPUT_RANDOM:
+            for(i=0; i<size; i++)
+                buffer[i] = (unsigned char) bench_random(&state);
+            break;
+
+        case INPUT_TEXT:
+            while(i < size){
+                //le prime parole del vocabolario sono le più frequenti
+                unsigned long long r = bench_random(&state);
+                size_t n_words = sizeof(words) / sizeof(words[0]);
+                size_t w = (size_t) ((r % n_words) * ((r >> 16) % n_words) / n_words);
+                for(const char *c = words[w]; *c != '\0' && i < size; c++)
+                    buffer[i++] = (unsigned char) *c;
+                if(i < size)
+                    buffer[i++] = (r >> 32) % 16 == 0 ? '.' : ((r >> 32) % 64 == 1 ? '\n' : ' ');
+            }
+            break;
+
+        case INPUT_REPETITIVE:
+            for(i=0; i<sizeof(pattern); i++)
+                pattern[i] = (unsigned char) bench_random(&state);
+            for(i=0; i<size; i++){
+                buffer[i] = pattern[i % sizeof(pattern)];
+                if(bench_random(&state) % 1000 == 0)
+                    buffer[i] = (unsigned char) bench_random(&state);
+            }
+            break;
+
+        default:
+            memset(buffer, 0, size);
+            break;
+    }
+}
+
+/***********************************************************************************************************************
+ * void bench_header(const char *, const char *)
+ *
+ * Stampa l'intestazione della tabella dei risultati.
+ *
+ * @param codec
+ * @param unit      --> cosa viene contato dal parametro units di bench_run (byte elaborati, operazioni, ...)
+ */
+void bench_header(const char *codec, const char *unit){
+    bench_codec = codec;
+    printf("\n%s microbenchmarks (%d repetitions, %lu bytes of input, unit = %s)\n\n", codec, bench_repetitions,
+           (unsigned long) bench_size, unit);
+    printf("%-16s %-12s %14s %14s %10s %10s\n", "kernel", "input", "median [ns]", "min [ns]", "ns/unit", "M/s");
+}
+
+static int compare_times(const void *a, const void *b){
+    unsigned long long x = *(const unsigned long long *) a;
+    unsigned long long y = *(const unsigned long long *) b;
+    return x < y ? -1 : x > y;
+}
+
+/***********************************************************************************************************************
+ * void bench_run(const char *, enum bench_input, bench_kernel, void *, unsigned long long)
+ *
+ * Esecuzione di un kernel: una volta a vuoto (cache e branch predictor "caldi") e poi bench_repetitions volte.
+ *
+ * @param kernel    --> nome del kernel
+ * @param input     --> tipo di dati sintetici usati
+ * @param fn        --> funzione da misurare
+ * @param arg       --> argomento passato a fn
+ * @param units     --> unità elaborate da una esecuzione di fn (per il calcolo di ns/unità e milioni di unità/s)
+ */
+void bench_run(const char *kernel, enum bench_input input, bench_kernel fn, void *arg, unsigned long long units){
+    unsigned long long times[MAX_REPETITIONS];
+    unsigned long long median, min;
+    const char *path = getenv("LZ_BENCH_JSON");
+
+    fn(arg);
+    for(int i=0; i<bench_repetitions; i++){
+        unsigned long long begin = time_now_ns();
+        fn(arg);
+        times[i] = time_now_ns() - begin;
+    }
+
+    qsort(times, (size_t) bench_repetitions, sizeof(times[0]), compare_times);
+    median = times[bench_repetitions / 2];
+    min = times[0];
+
+    printf("%-16s %-12s %14llu %14llu %10.3f %10.1f\n", kernel, bench_input_names[input], median, min,
+           units ? (double) median / (double) units : 0.0,
+           median ? (double) units * 1000.0 / (double) median : 0.0);
+    fflush(stdout);
+
+    if(path != NULL && *path != '\0'){
+        FILE *out = fopen(path, "a");
+        if(out != NULL){
+            fprintf(out, "{\"codec\":\"%s\",\"kernel\":\"%s\",\"input\":\"%s\",\"units\":%llu,\"median_ns\":%llu,"
+                         "\"min_ns\":%llu}\n", bench_codec, kernel, bench_input_names[input], units, median, min);
+            fclose(out);
+        }
+    }
+}
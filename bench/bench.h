@@ -0,0 +1,58 @@
+/***********************************************************************************************************************
+ *
+ *  bench.h
+ *
+ *  Funzioni comuni ai microbenchmark di LZ77 (bench_lz77.c) e LZ78 (bench_lz78.c).
+ *
+ ***********************************************************************************************************************
+ *
+ *  Ogni microbenchmark misura una singola funzione dell'algoritmo (kernel) su dati sintetici generati in modo
+ *  deterministico (stesso seme ad ogni esecuzione):
+ *
+ *  random      byte casuali (incomprimibili)
+ *  text        parole prese da un vocabolario con frequenze diverse, separate da spazi e punteggiatura
+ *  repetitive  una sequenza di 100 byte ripetuta con rare modifiche
+ *  zeros       solo byte a zero
+ *
+ *  Ogni kernel viene eseguito una volta a vuoto e poi ripetuto più volte, viene riportata la mediana (più stabile
+ *  della media in presenza di disturbi) e il minimo dei tempi misurati.
+ *
+ *  Uso:  bench_lz77 [-r ripetizioni] [-s byte] [filtro]
+ *
+ *  -r      numero di ripetizioni di ogni misura (default 11)
+ *  -s      grandezza dei dati sintetici in byte (default 65536)
+ *  filtro  esegue solo i kernel il cui nome contiene la stringa indicata
+ *
+ *  Se la variabile d'ambiente LZ_BENCH_JSON è impostata, ogni misura viene aggiunta al file indicato come riga JSON,
+ *  in modo da poter confrontare i risultati di versioni diverse.
+ *
+ **********************************************************************************************************************/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+enum bench_input {
+    INPUT_RANDOM,
+    INPUT_TEXT,
+    INPUT_REPETITIVE,
+    INPUT_ZEROS,
+    N_INPUTS
+};
+
+extern const char *bench_input_names[N_INPUTS];
+
+extern int bench_repetitions;           //ripetizioni di ogni misura
+extern size_t bench_size;               //grandezza dei dati sintetici
+extern volatile unsigned long bench_sink;   //risultati dei kernel, impedisce al compilatore di eliminarli
+
+typedef void (*bench_kernel)(void *arg);
+
+void bench_parse_args(int argc, char *argv[]);
+int bench_selected(const char *kernel);
+void bench_fill(unsigned char *buffer, size_t size, enum bench_input input);
+void bench_header(const char *codec, const char *unit);
+void bench_run(const char *kernel, enum bench_input input, bench_kernel fn, void *arg, unsigned long long units);
+
+#endif
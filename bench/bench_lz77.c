@@ -0,0 +1,148 @@
+/***********************************************************************************************************************
+ *
+ *  bench_lz77.c
+ *
+ *  Microbenchmark delle funzioni più usate dall'algoritmo LZ77 (vedi bench.h per le opzioni):
+ *
+ *  bit_write       scrittura bufferizzata delle codifiche (bufferizedWriting -> decToBin -> fillBuffer)
+ *  bit_read        lettura bufferizzata delle codifiche (extractCodes)
+ *  match_search    ricerca della sequenza più lunga nella finestra (findLongestMatch)
+ *  match_copy      ricostruzione dei byte a partire dalle codifiche (copyMatch)
+ *
+ *  Le codifiche usate da bit_write, bit_read e match_copy sono quelle generate dalla ricerca sui dati sintetici,
+ *  quindi hanno la stessa distribuzione di lunghezze e offset della compressione reale.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bench.h"
+#include "lz77.h"
+
+struct lz77_bench
+{
+    unsigned char *input;           //dati sintetici
+    size_t size;
+    struct code *tokens;            //codifiche generate dalla ricerca
+    size_t n_tokens;
+    FILE *stream;                   //codifiche bufferizzate
+    unsigned char *output;          //byte ricostruiti da match_copy
+};
+
+/*
+ * Stessa sequenza di ricerche del compressore (vedi encodeBlock): ricerca nella finestra, codifica e spostamento del
+ * lookahead di lunghezza+1 byte.
+ */
+static void run_match_search(void *arg){
+    struct lz77_bench *b = arg;
+    unsigned char *endOfBuffer = &b->input[b->size];
+    unsigned char *lookahead = b->input;
+    unsigned char *window;
+    size_t n = 0;
+
+    while (lookahead < endOfBuffer) {
+        window = (lookahead - b->input) > WINDOW ? lookahead - WINDOW : b->input;
+        findLongestMatch(lookahead, window, endOfBuffer, &b->tokens[n]);
+        if (b->tokens[n].l == 0)
+            b->tokens[n].a = *lookahead;
+        lookahead = lookahead + (b->tokens[n].l + 1);
+        n++;
+    }
+    b->n_tokens = n;
+}
+
+static void run_bit_write(void *arg){
+    struct lz77_bench *b = arg;
+    int buffer[BUFFER_SIZE];
+
+    inizializeArray(buffer, BUFFER_SIZE);
+    bits = 0;
+    rewind(b->stream);
+    for(size_t i=0; i<b->n_tokens; i++)
+        bufferizedWriting(&b->tokens[i], buffer, b->stream);
+    flushBits(buffer, b->stream);
+    fflush(b->stream);
+}
+
+/*
+ * Stessa sequenza di letture del decompressore (lunghezza, offset se la lunghezza non è nulla, carattere successivo)
+ */
+static void run_bit_read(void *arg){
+    struct lz77_bench *b = arg;
+    int buffer[BUFFER_SIZE];
+    unsigned long sum = 0;
+    int value;
+
+    initializeIntArray(buffer, BUFFER_SIZE);
+    rewind(b->stream);
+    buffer_position = 0;
+    for(size_t i=0; i<b->n_tokens; i++){
+        n_bits = (int) log2(LOOKAHEAD);
+        value = extractCodes(buffer, b->stream);
+        if(value == EOF)
+            break;
+        if(value != 0){
+            n_bits = (int) log2(WINDOW);
+            sum += (unsigned long) extractCodes(buffer, b->stream);
+        }
+        n_bits = 8;
+        sum += (unsigned long) extractCodes(buffer, b->stream);
+    }
+    bench_sink += sum;
+}
+
+static void run_match_copy(void *arg){
+    struct lz77_bench *b = arg;
+    unsigned char *d_lookahead = b->output;
+
+    for(size_t i=0; i<b->n_tokens; i++){
+        if(b->tokens[i].l != 0)
+            d_lookahead = copyMatch(d_lookahead, b->tokens[i].o, b->tokens[i].l);
+        *d_lookahead = b->tokens[i].a;
+        d_lookahead++;
+    }
+    bench_sink += (unsigned long) (d_lookahead - b->output);
+}
+
+int main(int argc, char *argv[]){
+    struct lz77_bench b;
+
+    bench_parse_args(argc, argv);
+    bench_header("lz77", "input byte");
+
+    b.size = bench_size;
+    b.input = malloc(b.size);
+    b.tokens = malloc(b.size * sizeof(struct code));
+    b.output = malloc(b.size);
+    b.stream = tmpfile();
+    if(b.input == NULL || b.tokens == NULL || b.output == NULL || b.stream == NULL){
+        printf("!WARNING! Cannot allocate benchmark buffers\n");
+        return 1;
+    }
+
+    for(int input=0; input<N_INPUTS; input++){
+        bench_fill(b.input, b.size, (enum bench_input) input);
+
+        //le codifiche servono a tutti gli altri kernel, la ricerca viene quindi fatta sempre almeno una volta
+        if(bench_selected("match_search"))
+            bench_run("match_search", (enum bench_input) input, run_match_search, &b, b.size);
+        else
+            run_match_search(&b);
+
+        run_bit_write(&b);
+        if(bench_selected("bit_write"))
+            bench_run("bit_write", (enum bench_input) input, run_bit_write, &b, b.size);
+        if(bench_selected("bit_read"))
+            bench_run("bit_read", (enum bench_input) input, run_bit_read, &b, b.size);
+        if(bench_selected("match_copy"))
+            bench_run("match_copy", (enum bench_input) input, run_match_copy, &b, b.size);
+    }
+
+    fclose(b.stream);
+    free(b.input);
+    free(b.tokens);
+    free(b.output);
+    return 0;
+}
@@ -0,0 +1,194 @@
+/***********************************************************************************************************************
+ *
+ *  bench_lz78.c
+ *
+ *  Microbenchmark delle funzioni del dizionario LZ78 (vedi bench.h per le opzioni):
+ *
+ *  dict_lookup     ricerca delle frasi nel dizionario pieno (search_child)
+ *  dict_insert     costruzione del dizionario con le frasi dei dati sintetici (search_child e add_child)
+ *  bit_write       scrittura bufferizzata dei codici (output_writing_file -> write_bits)
+ *  bit_read        lettura bufferizzata dei codici (output_reading_file -> read_bits)
+ *
+ *  dict_insert divide i dati sintetici in frasi come il compressore finchè il dizionario non è pieno, ogni byte è una
+ *  ricerca. dict_lookup segue nel dizionario pieno frasi di lunghezza da 1 a 8 byte prese dai dati sintetici (le frasi
+ *  più lunghe di quelle presenti si fermano al primo byte non trovato). bit_write e bit_read usano i codici generati
+ *  dalla compressione di tutti i dati sintetici.
+ *
+ **********************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "lz78.h"
+
+#define LOOKUPS 256             // frasi cercate da una esecuzione di dict_lookup
+
+struct lz78_bench
+{
+    unsigned char *input;
+    size_t size;
+    Arena *arena;                       // memoria del dizionario
+    Trie *trie;
+    unsigned long long inserted;        // byte elaborati da dict_insert
+    unsigned long long looked_up;       // byte cercati da dict_lookup
+    Output *tokens;                     // codici generati dalla compressione
+    size_t n_tokens;
+    FILE *stream;                       // codici bufferizzati
+    BitWriter *writer;                  // vedi create_bit_writer
+    BitReader *reader;
+};
+
+/*
+ * Compressione dei dati sintetici: stessi codici (e stessa grandezza degli indici) del compressore
+ */
+static void make_tokens(struct lz78_bench *b){
+    unsigned int node = 0, child;
+    size_t n = 0;
+
+    inizialize_trie(b->trie);
+    global_index = 0;
+    for(size_t i=0; i<b->size; i++){
+        child = search_child(b->trie, node, b->input[i]);
+        if(child != 0){
+            node = child;
+            continue;
+        }
+        b->tokens[n].index = node;
+        b->tokens[n].next_value = b->input[i];
+        n++;
+        add_child(b->trie, node, b->input[i], ++global_index);
+        if(global_index == DICTIONARY_SIZE){
+            inizialize_trie(b->trie);
+            global_index = 0;
+        }
+        node = 0;
+    }
+    b->n_tokens = n;
+}
+
+static void run_dict_insert(void *arg){
+    struct lz78_bench *b = arg;
+    unsigned int node = 0, child, index = 0;
+    size_t i;
+
+    inizialize_trie(b->trie);
+    for(i=0; i<b->size && index<DICTIONARY_SIZE; i++){
+        child = search_child(b->trie, node, b->input[i]);
+        if(child != 0){
+            node = child;
+        } else {
+            add_child(b->trie, node, b->input[i], ++index);
+            node = 0;
+        }
+    }
+    b->inserted = i;
+}
+
+static void run_dict_lookup(void *arg){
+    struct lz78_bench *b = arg;
+    unsigned long long looked_up = 0;
+    unsigned long sum = 0;
+
+    for(size_t i=0; i<LOOKUPS; i++){
+        size_t position = (i * 7919) % b->size;
+        size_t length = 1 + i % 8;
+        unsigned int node = 0;
+        for(size_t j=0; j<length && position + j < b->size; j++){
+            node = search_child(b->trie, node, b->input[position + j]);
+            looked_up++;
+            if(node == 0)
+                break;
+        }
+        sum += node;
+    }
+    b->looked_up = looked_up;
+    bench_sink += sum;
+}
+
+static void run_bit_write(void *arg){
+    struct lz78_bench *b = arg;
+
+    rewind(b->stream);
+    bit_writer_init(b->writer, b->stream);
+    global_index = 0;
+    for(size_t i=0; i<b->n_tokens; i++){
+        output_writing_file(&b->tokens[i], b->writer);
+        if(++global_index == DICTIONARY_SIZE)
+            global_index = 0;
+    }
+    flush_bits(b->writer);
+    fflush(b->stream);
+}
+
+static void run_bit_read(void *arg){
+    struct lz78_bench *b = arg;
+    Output output;
+    unsigned long sum = 0;
+
+    rewind(b->stream);
+    bit_reader_init(b->reader, b->stream);
+    global_index = 0;
+    while(output_reading_file(&output, b->reader)){
+        sum += output.index + output.next_value;
+        if(++global_index == DICTIONARY_SIZE)
+            global_index = 0;
+    }
+    bench_sink += sum;
+}
+
+int main(int argc, char *argv[]){
+    static struct lz78_bench b;
+
+    bench_parse_args(argc, argv);
+    bench_header("lz78", "dictionary operation");
+
+    b.size = bench_size;
+    b.input = malloc(b.size);
+    b.arena = arena_create(trie_bytes(DICTIONARY_SIZE));
+    b.trie = b.arena != NULL ? create_trie(b.arena, DICTIONARY_SIZE) : NULL;
+    b.tokens = malloc(b.size * sizeof(Output));
+    b.stream = tmpfile();
+    b.writer = create_bit_writer();
+    b.reader = create_bit_reader();
+    if(b.input == NULL || b.trie == NULL || b.tokens == NULL || b.stream == NULL || b.writer == NULL ||
+       b.reader == NULL){
+        printf("!WARNING! Cannot allocate benchmark buffers\n");
+        return 1;
+    }
+
+    for(int input=0; input<N_INPUTS; input++){
+        bench_fill(b.input, b.size, (enum bench_input) input);
+
+        //il dizionario pieno serve anche a dict_lookup, viene quindi costruito sempre almeno una volta
+        run_dict_insert(&b);
+        if(bench_selected("dict_insert"))
+            bench_run("dict_insert", (enum bench_input) input, run_dict_insert, &b, b.inserted);
+
+        run_dict_lookup(&b);
+        if(bench_selected("dict_lookup"))
+            bench_run("dict_lookup", (enum bench_input) input, run_dict_lookup, &b, b.looked_up);
+
+        //file nuovo per ogni tipo di dati, bit_read legge fino alla fine del file
+        fclose(b.stream);
+        b.stream = tmpfile();
+        if(b.stream == NULL){
+            printf("!WARNING! Cannot create the benchmark stream\n");
+            return 1;
+        }
+        make_tokens(&b);
+        run_bit_write(&b);
+        if(bench_selected("bit_write"))
+            bench_run("bit_write", (enum bench_input) input, run_bit_write, &b, b.n_tokens);
+        if(bench_selected("bit_read"))
+            bench_run("bit_read", (enum bench_input) input, run_bit_read, &b, b.n_tokens);
+    }
+
+    fclose(b.stream);
+    free(b.input);
+    free(b.tokens);
+    free(b.writer);
+    free(b.reader);
+    arena_free(b.arena);
+    return 0;
+}
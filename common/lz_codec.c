@@ -0,0 +1,109 @@
+/***********************************************************************************************************************
+ *
+ *  lz_codec.c
+ *
+ *  Codec stored e scelta del codec (vedi lz_codec.h).
+ *
+ **********************************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "lz_codec.h"
+#include "lz_timing.h"
+
+/***********************************************************************************************************************
+ * Codec stored: il blocco compresso è il blocco originale.
+ */
+static size_t stored_bound(size_t raw_size){
+    return raw_size;
+}
+
+static size_t stored_compress(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity){
+    if(raw_size > capacity)
+        return 0;
+    memcpy(packed, raw, raw_size);
+    return raw_size;
+}
+
+static int stored_decompress(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size){
+    if(packed_size != raw_size)
+        return 1;
+    memcpy(raw, packed, raw_size);
+    return 0;
+}
+
+const LZCodec stored_codec = { CODEC_STORED, "stored", stored_bound, stored_compress, stored_decompress, NULL, NULL };
+
+static const LZCodec *codecs[N_CODECS] = { &stored_codec, &lz77_codec, &lz78_codec };
+
+/***********************************************************************************************************************
+ * const LZCodec *codec_by_id(int)
+ * const LZCodec *codec_by_name(const char *)
+ *
+ * Ricerca di un codec per identificatore (intestazione dei blocchi) o per nome (riga di comando).
+ *
+ * @return  --> codec, NULL se non esiste
+ */
+const LZCodec *codec_by_id(int id){
+    return id >= 0 && id < N_CODECS ? codecs[id] : NULL;
+}
+
+const LZCodec *codec_by_name(const char *name){
+    for(int i=0; i<N_CODECS; i++){
+        if(!strcmp(codecs[i]->name, name))
+            return codecs[i];
+    }
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * const LZCodec *codec_select(unsigned char [], size_t, unsigned char [])
+ *
+ * Scelta automatica del codec di un blocco: un campione di AUTO_SAMPLE byte, fatto da AUTO_SLICES pezzi presi a
+ * distanza regolare dall'inizio alla fine del blocco (i dati possono cambiare all'interno del blocco), viene compresso
+ * da ogni codec e viene misurato il tempo di compressione. Tra i codec che comprimono il campione al massimo
+ * AUTO_TOLERANCE in meno del migliore viene scelto il più veloce, quindi se nessun codec riduce il campione di almeno
+ * AUTO_TOLERANCE il blocco viene memorizzato così com'è (il codec stored ha tempo nullo).
+ * Il campione è corto rispetto al blocco, la scelta favorisce quindi leggermente LZ77 (finestra piccola, impara
+ * subito) rispetto a LZ78 (il dizionario migliora con la lunghezza dei dati).
+ *
+ * @param raw
+ * @param raw_size
+ * @param scratch   --> almeno 2 * AUTO_SAMPLE byte per il campione e il campione compresso
+ * @return          --> codec scelto
+ */
+const LZCodec *codec_select(unsigned char raw[], size_t raw_size, unsigned char scratch[]){
+    size_t sample = raw_size < AUTO_SAMPLE ? raw_size : AUTO_SAMPLE;
+    size_t slice = AUTO_SAMPLE / AUTO_SLICES;
+    unsigned char *packed = scratch + AUTO_SAMPLE;
+    size_t sizes[N_CODECS];
+    unsigned long long times[N_CODECS];
+    size_t best = sample;
+    int chosen = -1;
+
+    if(raw_size > AUTO_SAMPLE){
+        for(size_t i=0; i<AUTO_SLICES; i++)
+            memcpy(scratch + i * slice, raw + i * ((raw_size - slice) / (AUTO_SLICES - 1)), slice);
+        raw = scratch;
+    }
+
+    sizes[CODEC_STORED] = sample;
+    times[CODEC_STORED] = 0;
+    for(int i=CODEC_STORED+1; i<N_CODECS; i++){
+        unsigned long long begin = time_now_ns();
+        sizes[i] = codecs[i]->compress(raw, sample, packed, sample);
+        times[i] = time_now_ns() - begin;
+        if(sizes[i] == 0)                           //il campione compresso non è più piccolo del campione
+            sizes[i] = sample;
+        if(sizes[i] < best)
+            best = sizes[i];
+    }
+
+    for(int i=0; i<N_CODECS; i++){
+        if((double) sizes[i] > (double) best * (1.0 + AUTO_TOLERANCE))
+            continue;
+        if(chosen < 0 || times[i] < times[chosen])
+            chosen = i;
+    }
+    return codecs[chosen];
+}
@@ -0,0 +1,59 @@
+/***********************************************************************************************************************
+ *
+ *  lz_codec.h
+ *
+ *  Interfaccia comune dei codec (LZ77, LZ78 e blocco memorizzato così com'è), usata dal programma LZ (vedi LZ/lz.c).
+ *
+ ***********************************************************************************************************************
+ *
+ *  Ogni codec comprime e decomprime un blocco in memoria indipendente dagli altri blocchi:
+ *
+ *  bound           grandezza massima dei byte compressi di un blocco di raw_size byte
+ *  compress        compressione di raw_size byte in packed (al massimo capacity byte), restituisce i byte compressi o
+ *                  0 se il blocco compresso non sta in capacity byte
+ *  decompress      decompressione di packed_size byte in esattamente raw_size byte, restituisce 0 se il blocco è stato
+ *                  decompresso e 1 se il blocco non è valido (stessa convenzione di LZ77_decompressor e
+ *                  LZ78_decompressor)
+ *  write_params    scrittura dei parametri del codec necessari alla decompressione (grandezza della finestra, del
+ *                  dizionario, ...) nell'intestazione del file compresso, NULL se il codec non ha parametri
+ *  read_params     lettura e controllo dei parametri scritti da write_params, restituisce 1 se i parametri sono validi
+ *
+ *  Il codec LZ77 è definito in LZ77/lz77.c, il codec LZ78 in LZ78_V4/lz78.c (con la variante, la gestione del
+ *  dizionario pieno e la grandezza del dizionario impostate nelle variabili globali di lz78.h), il codec stored e la
+ *  scelta automatica del codec in lz_codec.c.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <stdio.h>
+
+#define CODEC_STORED 0              //byte originali copiati così come sono
+#define CODEC_LZ77 1                //blocchi LZ77 (vedi LZ77_compressBuffer)
+#define CODEC_LZ78 2                //codici LZ78 (vedi LZ78_compress_buffer)
+#define N_CODECS 3
+
+#define AUTO_SAMPLE 32768           //byte del blocco compressi da ogni codec per la scelta automatica
+#define AUTO_SLICES 4               //pezzi del campione, distribuiti su tutto il blocco
+#define AUTO_TOLERANCE 0.02         //un codec più veloce viene scelto se comprime al massimo il 2% in meno del migliore
+
+typedef struct _lz_codec{
+    int id;                                     //scritto nell'intestazione di ogni blocco
+    const char *name;
+    size_t (*bound)(size_t raw_size);
+    size_t (*compress)(unsigned char raw[], size_t raw_size, unsigned char packed[], size_t capacity);
+    int (*decompress)(unsigned char packed[], size_t packed_size, unsigned char raw[], size_t raw_size);
+    void (*write_params)(FILE *file);
+    int (*read_params)(FILE *file);
+}LZCodec;
+
+extern const LZCodec stored_codec;
+extern const LZCodec lz77_codec;
+extern const LZCodec lz78_codec;
+
+const LZCodec *codec_by_id(int id);
+const LZCodec *codec_by_name(const char *name);
+const LZCodec *codec_select(unsigned char raw[], size_t raw_size, unsigned char scratch[]);
+
+#endif
@@ -0,0 +1,53 @@
+/***********************************************************************************************************************
+ *
+ *  lz_memory.c
+ *
+ *  Lettura e divisione del limite di memoria (vedi lz_memory.h).
+ *
+ **********************************************************************************************************************/
+
+#include <stdlib.h>
+#include <ctype.h>
+#include "lz_memory.h"
+#include "lz_pipeline.h"
+
+/***********************************************************************************************************************
+ * size_t mem_parse(const char *)
+ *
+ * Lettura di un limite di memoria in byte, con i suffissi K, M e G (potenze di 1024): "300000", "512K", "4M".
+ *
+ * @param text
+ * @return      --> byte, 0 se il testo non è valido o il limite è più piccolo di MEM_MIN_LIMIT
+ */
+size_t mem_parse(const char *text){
+    unsigned long long value;
+    int shift = 0;
+    char *end;
+
+    if(text == NULL || !isdigit((unsigned char) *text))
+        return 0;
+    value = strtoull(text, &end, 10);
+    switch(toupper((unsigned char) *end)){
+        case 'K': shift = 10; break;
+        case 'M': shift = 20; break;
+        case 'G': shift = 30; break;
+    }
+    if(shift > 0)
+        end++;
+    if(*end != '\0' || value > ((size_t) -1) >> shift || (value << shift) < MEM_MIN_LIMIT)
+        return 0;
+    return (size_t) (value << shift);
+}
+
+/***********************************************************************************************************************
+ * size_t mem_split(size_t)
+ *
+ * Divisione del limite: la pipeline riceve al massimo un quarto del limite (vedi pipe_limit_memory), il codec il
+ * resto. Va chiamata prima di aprire gli stream della pipeline.
+ *
+ * @param limit
+ * @return      --> memoria del codec
+ */
+size_t mem_split(size_t limit){
+    return limit - pipe_limit_memory(limit / 4);
+}
@@ -0,0 +1,29 @@
+/***********************************************************************************************************************
+ *
+ *  lz_memory.h
+ *
+ *  Limite di memoria (opzione --mem-limit), condiviso da LZ77 e LZ78.
+ *
+ ***********************************************************************************************************************
+ *
+ *  Senza limite la memoria usata dai programmi è fissata dai buffer dei codec e della pipeline (alcuni MB). Con
+ *  --mem-limit la memoria viene divisa tra la pipeline (vedi pipe_limit_memory in lz_pipeline.h), che riceve al
+ *  massimo un quarto del limite, e il codec, che riceve il resto e dimensiona di conseguenza i suoi buffer (finestre,
+ *  pezzi letti e scritti, codifiche, dizionari). Il formato dei file compressi non cambia.
+ *
+ *  Il limite riguarda i buffer grandi, non lo stack, il codice e le librerie: conviene lasciare un margine rispetto
+ *  alla memoria davvero disponibile. Sotto MEM_MIN_LIMIT i codec non possono funzionare.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_MEMORY_H
+#define LZ_MEMORY_H
+
+#include <stddef.h>
+
+#define MEM_MIN_LIMIT 262144        //limite più piccolo accettato (256 KB)
+
+size_t mem_parse(const char *text);
+size_t mem_split(size_t limit);
+
+#endif
@@ -0,0 +1,569 @@
+/***********************************************************************************************************************
+ *
+ *  lz_pipeline.c
+ *
+ *  Implementazione della pipeline lettore / codec / scrittore (vedi lz_pipeline.h).
+ *
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE                 //fopencookie
+
+#include <stdlib.h>
+#include <string.h>
+#include "lz_pipeline.h"
+#include "lz_uring.h"
+
+#if LZ_PIPELINE && defined(__GLIBC__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define QUEUE_SLOTS 4               //posizioni di una coda, potenza di 2 maggiore di PIPE_CHUNKS
+#define WAIT_YIELDS 16              //tentativi con sched_yield prima di iniziare le pause
+#define WAIT_PAUSE 100000           //pausa tra i tentativi successivi [ns]
+
+static size_t chunk_size = PIPE_CHUNK_SIZE;     //byte di ogni pezzo, 0 = pipeline disattivata (pipe_limit_memory)
+
+typedef struct _pipe_chunk{
+    unsigned char *bytes;
+    size_t size;                    //byte validi, 0 = fine del file
+    size_t done;                    //byte già letti o scritti da io_uring
+    long long offset;               //posizione del pezzo nel file (io_uring)
+}PipeChunk;
+
+//Coda circolare con un solo produttore e un solo consumatore: head viene scritto solo dal consumatore, tail solo dal
+//produttore, quindi bastano letture e scritture atomiche (acquire / release) senza lock.
+typedef struct _pipe_queue{
+    PipeChunk *slot[QUEUE_SLOTS];
+    size_t head;                    //prossima posizione da estrarre
+    size_t tail;                    //prossima posizione da inserire
+}PipeQueue;
+
+typedef struct _pipe{
+    FILE *file;
+    PipeChunk chunk[PIPE_CHUNKS];
+    PipeQueue full;                 //pezzi pieni: dal lettore al codec o dal codec allo scrittore
+    PipeQueue empty;                //pezzi vuoti restituiti
+    PipeChunk *current;             //pezzo usato dal codec
+    size_t position;                //prossimo byte di current da leggere (solo lettura)
+    int closing;                    //lo stream è stato chiuso dal codec
+    int error;                      //errore di lettura o di scrittura del file
+    int started;                    //il thread della pipeline è stato creato
+    pthread_t thread;
+    Uring *ring;                    //anello io_uring del thread, NULL se il thread usa fread / fwrite
+    int fd;                         //descrittore del file (io_uring)
+    long long offset;               //posizione del prossimo pezzo nel file (io_uring)
+    long long end;                  //grandezza del file da leggere (io_uring)
+}Pipe;
+
+/***********************************************************************************************************************
+ * int queue_push(PipeQueue *, PipeChunk *)
+ * PipeChunk *queue_pop(PipeQueue *)
+ *
+ * Inserimento ed estrazione di un pezzo. Ogni stream ha solo PIPE_CHUNKS pezzi e una coda ha QUEUE_SLOTS > PIPE_CHUNKS
+ * posizioni, quindi l'inserimento non trova mai la coda piena.
+ *
+ * @return  --> 1 se il pezzo è stato inserito / pezzo estratto, NULL se la coda è vuota
+ */
+static int queue_push(PipeQueue *queue, PipeChunk *chunk){
+    size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+
+    if(tail - __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == QUEUE_SLOTS)
+        return 0;
+    queue->slot[tail % QUEUE_SLOTS] = chunk;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static PipeChunk *queue_pop(PipeQueue *queue){
+    size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    PipeChunk *chunk;
+
+    if(head == __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE))
+        return NULL;
+    chunk = queue->slot[head % QUEUE_SLOTS];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return chunk;
+}
+
+/***********************************************************************************************************************
+ * PipeChunk *queue_wait(PipeQueue *, int *)
+ *
+ * Estrazione di un pezzo aspettando che la coda non sia vuota: i primi WAIT_YIELDS tentativi cedono il processore
+ * agli altri thread, poi il thread si ferma per WAIT_PAUSE ns tra un tentativo e l'altro (un thread in attesa non
+ * occupa un processore per tutto il tempo di un pezzo).
+ *
+ * @param queue
+ * @param closing   --> se non è NULL l'attesa termina quando *closing diventa diverso da 0
+ * @return          --> pezzo estratto, NULL se l'attesa è stata interrotta da closing
+ */
+static PipeChunk *queue_wait(PipeQueue *queue, int *closing){
+    struct timespec pause = { 0, WAIT_PAUSE };
+    PipeChunk *chunk;
+
+    for(int i=0; ; i++){
+        if(closing != NULL && __atomic_load_n(closing, __ATOMIC_ACQUIRE))
+            return NULL;
+        if((chunk = queue_pop(queue)) != NULL)
+            return chunk;
+        if(i < WAIT_YIELDS)
+            sched_yield();
+        else
+            nanosleep(&pause, NULL);
+    }
+}
+
+/***********************************************************************************************************************
+ * Pipe *pipe_create(FILE *)
+ * void pipe_destroy(Pipe *)
+ *
+ * Allocazione di una pipeline con tutti i pezzi nella coda dei pezzi vuoti.
+ *
+ * @return  --> pipeline, NULL se la memoria non è sufficiente
+ */
+static void pipe_destroy(Pipe *pipe){
+    uring_destroy(pipe->ring);
+    for(int i=0; i<PIPE_CHUNKS; i++)
+        free(pipe->chunk[i].bytes);
+    free(pipe);
+}
+
+static Pipe *pipe_create(FILE *file){
+    Pipe *pipe = calloc(1, sizeof(Pipe));
+
+    if(pipe == NULL)
+        return NULL;
+    pipe->file = file;
+    for(int i=0; i<PIPE_CHUNKS; i++){
+        if((pipe->chunk[i].bytes = malloc(chunk_size)) == NULL){
+            pipe_destroy(pipe);
+            return NULL;
+        }
+        queue_push(&pipe->empty, &pipe->chunk[i]);
+    }
+    return pipe;
+}
+
+/***********************************************************************************************************************
+*                                                       LETTURA                                                        *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * void *reader_thread(void *)
+ *
+ * Thread lettore: riempie i pezzi vuoti con fread finché il file non finisce. La fine del file è segnalata al codec da
+ * un pezzo con 0 byte; il thread termina prima se il codec chiude lo stream.
+ */
+static void *reader_thread(void *arg){
+    Pipe *pipe = arg;
+    PipeChunk *chunk;
+    size_t size;
+
+    do{
+        if((chunk = queue_wait(&pipe->empty, &pipe->closing)) == NULL)
+            break;
+        size = fread(chunk->bytes, sizeof(unsigned char), chunk_size, pipe->file);
+        if(size < chunk_size && ferror(pipe->file))
+            __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+        chunk->size = size;
+        queue_push(&pipe->full, chunk);
+    } while(size > 0);
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * ssize_t reader_read(void *, char *, size_t)
+ * int reader_close(void *)
+ *
+ * Funzioni dello stream di lettura (fopencookie): reader_read copia i byte dei pezzi letti in anticipo, restituendo al
+ * lettore i pezzi consumati; reader_close ferma il lettore, libera i pezzi e riporta gli errori di lettura.
+ */
+static ssize_t reader_read(void *cookie, char *buffer, size_t size){
+    Pipe *pipe = cookie;
+    size_t n;
+
+    while(pipe->current == NULL || pipe->position == pipe->current->size){
+        if(pipe->current != NULL){
+            if(pipe->current->size == 0)            //fine del file: il pezzo vuoto resta in current
+                return __atomic_load_n(&pipe->error, __ATOMIC_ACQUIRE) ? -1 : 0;
+            queue_push(&pipe->empty, pipe->current);
+        }
+        pipe->current = queue_wait(&pipe->full, NULL);
+        pipe->position = 0;
+    }
+
+    n = pipe->current->size - pipe->position < size ? pipe->current->size - pipe->position : size;
+    memcpy(buffer, pipe->current->bytes + pipe->position, n);
+    pipe->position += n;
+    return (ssize_t) n;
+}
+
+static int reader_close(void *cookie){
+    Pipe *pipe = cookie;
+    int error;
+
+    __atomic_store_n(&pipe->closing, 1, __ATOMIC_RELEASE);
+    if(pipe->started)
+        pthread_join(pipe->thread, NULL);
+    error = pipe->error;
+    pipe_destroy(pipe);
+    return error ? -1 : 0;
+}
+
+/***********************************************************************************************************************
+*                                                      SCRITTURA                                                       *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * void *writer_thread(void *)
+ *
+ * Thread scrittore: scrive i pezzi pieni con fwrite e li restituisce vuoti. Termina con il pezzo di 0 byte inviato da
+ * writer_close. Dopo un errore di scrittura i pezzi vengono restituiti senza scriverli, in modo che il codec non resti
+ * mai in attesa.
+ */
+static void *writer_thread(void *arg){
+    Pipe *pipe = arg;
+    PipeChunk *chunk;
+
+    while((chunk = queue_wait(&pipe->full, NULL))->size > 0){
+        if(!pipe->error && fwrite(chunk->bytes, sizeof(unsigned char), chunk->size, pipe->file) != chunk->size)
+            __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+        queue_push(&pipe->empty, chunk);
+    }
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * ssize_t writer_write(void *, const char *, size_t)
+ * int writer_close(void *)
+ *
+ * Funzioni dello stream di scrittura (fopencookie): writer_write copia i byte nel pezzo corrente e passa allo
+ * scrittore ogni pezzo pieno; writer_close passa l'ultimo pezzo e il pezzo di 0 byte, aspetta la fine dello scrittore
+ * e svuota il buffer del file.
+ */
+static ssize_t writer_write(void *cookie, const char *buffer, size_t size){
+    Pipe *pipe = cookie;
+    size_t copied = 0, n;
+
+    if(__atomic_load_n(&pipe->error, __ATOMIC_ACQUIRE))
+        return -1;
+    while(copied < size){
+        if(pipe->current == NULL){
+            pipe->current = queue_wait(&pipe->empty, NULL);
+            pipe->current->size = 0;
+        }
+        n = chunk_size - pipe->current->size < size - copied ? chunk_size - pipe->current->size : size - copied;
+        memcpy(pipe->current->bytes + pipe->current->size, buffer + copied, n);
+        pipe->current->size += n;
+        copied += n;
+        if(pipe->current->size == chunk_size){
+            queue_push(&pipe->full, pipe->current);
+            pipe->current = NULL;
+        }
+    }
+    return (ssize_t) size;
+}
+
+static int writer_close(void *cookie){
+    Pipe *pipe = cookie;
+    int error;
+
+    if(pipe->current != NULL && pipe->current->size > 0){
+        queue_push(&pipe->full, pipe->current);
+        pipe->current = NULL;
+    }
+    if(pipe->current == NULL)
+        pipe->current = queue_wait(&pipe->empty, NULL);
+    pipe->current->size = 0;
+    queue_push(&pipe->full, pipe->current);
+    if(pipe->started)
+        pthread_join(pipe->thread, NULL);
+
+    //con io_uring il file è stato scritto con le posizioni, la posizione di stdio va portata alla fine dei pezzi
+    if(pipe->ring != NULL && fseeko(pipe->file, (off_t) pipe->offset, SEEK_SET) != 0)
+        pipe->error = 1;
+    error = pipe->error || fflush(pipe->file) == EOF;
+    pipe_destroy(pipe);
+    return error ? -1 : 0;
+}
+
+/***********************************************************************************************************************
+*                                                       IO_URING                                                       *
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * void *uring_reader_thread(void *)
+ *
+ * Thread lettore con io_uring (vedi lz_uring.h): ogni pezzo vuoto riceve subito la lettura della prossima parte del
+ * file, quindi tutti i pezzi che il codec non sta usando sono in lettura contemporaneamente. Le letture possono finire
+ * in un ordine qualsiasi, i pezzi vengono passati al codec nell'ordine del file (order contiene i pezzi in lettura
+ * dal primo all'ultimo). Una lettura incompleta viene ripetuta per i byte mancanti. Se il file è diventato più corto
+ * non vengono fatte altre letture e il codec riceve la fine del file dopo i byte letti; dopo un errore il codec
+ * riceve subito la fine del file (con l'errore), anche nei pezzi delle letture in corso se l'attesa stessa fallisce.
+ */
+static void *uring_reader_thread(void *arg){
+    Pipe *pipe = arg;
+    PipeChunk *order[PIPE_CHUNKS];
+    PipeChunk *chunk;
+    int first = 0, count = 0;
+    int buffer, result;
+
+    for(;;){
+        //nuove letture nei pezzi vuoti (il thread aspetta un pezzo vuoto solo se non ha letture in corso)
+        chunk = NULL;
+        if(pipe->offset < pipe->end && !__atomic_load_n(&pipe->closing, __ATOMIC_ACQUIRE))
+            chunk = count == 0 ? queue_wait(&pipe->empty, &pipe->closing) : queue_pop(&pipe->empty);
+        if(chunk != NULL){
+            chunk->size = pipe->end - pipe->offset < (long long) chunk_size ? (size_t) (pipe->end - pipe->offset) :
+                                                                              chunk_size;
+            chunk->done = 0;
+            chunk->offset = pipe->offset;
+            pipe->offset += (long long) chunk->size;
+            uring_read(pipe->ring, pipe->fd, (int) (chunk - pipe->chunk), 0, chunk->size, chunk->offset);
+            order[(first + count++) % PIPE_CHUNKS] = chunk;
+            continue;
+        }
+        if(count == 0)
+            break;
+
+        //attesa di una lettura
+        if(!uring_wait(pipe->ring, &buffer, &result)){
+            //le letture in corso sono perse: i loro pezzi tornano al codec come fine del file
+            __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+            while(count > 0){
+                order[first]->size = 0;
+                queue_push(&pipe->full, order[first]);
+                first = (first + 1) % PIPE_CHUNKS;
+                count--;
+            }
+            break;
+        }
+        chunk = &pipe->chunk[buffer];
+        if(result > 0)
+            chunk->done += (size_t) result;
+        if(result <= 0 || __atomic_load_n(&pipe->closing, __ATOMIC_ACQUIRE)){
+            if(result < 0)
+                __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+            chunk->size = chunk->done;
+            pipe->end = pipe->offset;
+        } else if(chunk->done < chunk->size){
+            uring_read(pipe->ring, pipe->fd, buffer, chunk->done, chunk->size - chunk->done,
+                       chunk->offset + (long long) chunk->done);
+        }
+
+        //pezzi completi passati al codec nell'ordine del file, dopo un errore come fine del file
+        while(count > 0 && order[first]->done == order[first]->size){
+            if(__atomic_load_n(&pipe->error, __ATOMIC_ACQUIRE))
+                order[first]->size = 0;
+            queue_push(&pipe->full, order[first]);
+            first = (first + 1) % PIPE_CHUNKS;
+            count--;
+        }
+    }
+
+    //fine del file (non serve se il codec ha chiuso lo stream)
+    if((chunk = queue_wait(&pipe->empty, &pipe->closing)) != NULL){
+        chunk->size = 0;
+        queue_push(&pipe->full, chunk);
+    }
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * void *uring_writer_thread(void *)
+ *
+ * Thread scrittore con io_uring: ogni pezzo pieno viene scritto subito alla sua posizione nel file, quindi tutti i
+ * pezzi completati dal codec sono in scrittura contemporaneamente e vengono restituiti vuoti appena la loro scrittura
+ * finisce. Una scrittura incompleta viene ripetuta per i byte mancanti. Il thread termina con il pezzo di 0 byte
+ * inviato da writer_close, dopo che tutte le scritture sono finite. Come in writer_thread, dopo un errore i pezzi
+ * vengono restituiti senza scriverli, quindi il codec non resta mai in attesa.
+ */
+static void *uring_writer_thread(void *arg){
+    Pipe *pipe = arg;
+    PipeChunk *chunk;
+    int busy[PIPE_CHUNKS] = { 0 };  //pezzi in scrittura
+    int count = 0, finished = 0;
+    int buffer, result;
+
+    for(;;){
+        //nuove scritture (il thread aspetta un pezzo pieno solo se non ha scritture in corso)
+        chunk = NULL;
+        if(!finished)
+            chunk = count == 0 ? queue_wait(&pipe->full, NULL) : queue_pop(&pipe->full);
+        if(chunk != NULL){
+            if(chunk->size == 0){
+                finished = 1;
+            } else if(__atomic_load_n(&pipe->error, __ATOMIC_ACQUIRE)){
+                queue_push(&pipe->empty, chunk);
+            } else {
+                chunk->done = 0;
+                chunk->offset = pipe->offset;
+                pipe->offset += (long long) chunk->size;
+                uring_write(pipe->ring, pipe->fd, (int) (chunk - pipe->chunk), 0, chunk->size, chunk->offset);
+                busy[chunk - pipe->chunk] = 1;
+                count++;
+            }
+            continue;
+        }
+        if(count == 0)
+            break;
+
+        //attesa di una scrittura
+        if(!uring_wait(pipe->ring, &buffer, &result)){
+            //le scritture in corso sono perse: i loro pezzi tornano vuoti e il thread continua a restituire i pezzi
+            //pieni fino al pezzo di 0 byte
+            __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+            for(int i=0; i<PIPE_CHUNKS; i++){
+                if(busy[i])
+                    queue_push(&pipe->empty, &pipe->chunk[i]);
+                busy[i] = 0;
+            }
+            count = 0;
+            continue;
+        }
+        chunk = &pipe->chunk[buffer];
+        if(result <= 0){
+            __atomic_store_n(&pipe->error, 1, __ATOMIC_RELEASE);
+            chunk->done = chunk->size;
+        } else {
+            chunk->done += (size_t) result;
+        }
+        if(chunk->done < chunk->size){
+            uring_write(pipe->ring, pipe->fd, buffer, chunk->done, chunk->size - chunk->done,
+                        chunk->offset + (long long) chunk->done);
+        } else {
+            busy[buffer] = 0;
+            queue_push(&pipe->empty, chunk);
+            count--;
+        }
+    }
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * int pipe_uring(Pipe *, int)
+ *
+ * Creazione dell'anello io_uring della pipeline con i pezzi come buffer registrati. io_uring viene usato solo per i
+ * file regolari (per pipe e terminali le letture e le scritture con posizione non hanno senso) e parte dalla
+ * posizione attuale del file; per la scrittura il buffer di stdio viene prima svuotato.
+ *
+ * @param pipe
+ * @param writing   --> 1 per lo stream di scrittura
+ * @return          --> 1 se il thread della pipeline può usare io_uring
+ */
+static int pipe_uring(Pipe *pipe, int writing){
+    unsigned char *buffers[PIPE_CHUNKS];
+    struct stat st;
+    off_t offset;
+
+    if((writing && fflush(pipe->file) == EOF) || (offset = ftello(pipe->file)) < 0)
+        return 0;
+    pipe->fd = fileno(pipe->file);
+    if(pipe->fd < 0 || fstat(pipe->fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return 0;
+    for(int i=0; i<PIPE_CHUNKS; i++)
+        buffers[i] = pipe->chunk[i].bytes;
+    if((pipe->ring = uring_create(buffers, PIPE_CHUNKS, chunk_size)) == NULL)
+        return 0;
+    pipe->offset = (long long) offset;
+    pipe->end = (long long) st.st_size;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * FILE *pipe_open(FILE *, int, cookie_io_functions_t, void *(*)(void *), void *(*)(void *))
+ *
+ * Creazione della pipeline, del suo thread e dello stream usato dal codec. Il thread usa io_uring se è disponibile
+ * (vedi pipe_uring), altrimenti fread / fwrite.
+ *
+ * @return  --> stream, il file stesso se la pipeline non può essere creata
+ */
+static FILE *pipe_open(FILE *file, int writing, cookie_io_functions_t functions, void *(*thread)(void *),
+                       void *(*uring_thread)(void *)){
+    Pipe *pipe = chunk_size > 0 ? pipe_create(file) : NULL;
+    FILE *stream;
+
+    if(pipe == NULL)
+        return file;
+    if((stream = fopencookie(pipe, writing ? "wb" : "rb", functions)) == NULL){
+        pipe_destroy(pipe);
+        return file;
+    }
+    if(pipe_uring(pipe, writing))
+        thread = uring_thread;
+    pipe->started = pthread_create(&pipe->thread, NULL, thread, pipe) == 0;
+    if(!pipe->started){
+        fclose(stream);                 //le funzioni di chiusura non aspettano il thread e liberano la pipeline
+        return file;
+    }
+    return stream;
+}
+
+#endif
+
+/***********************************************************************************************************************
+ * FILE *pipe_open_reader(FILE *)
+ * FILE *pipe_open_writer(FILE *)
+ *
+ * Apertura dello stream di lettura o di scrittura della pipeline sul file (vedi lz_pipeline.h).
+ *
+ * @param file  --> file aperto in lettura / scrittura
+ * @return      --> stream da usare al posto di file, file stesso se la pipeline non è disponibile
+ */
+FILE *pipe_open_reader(FILE *file){
+#if LZ_PIPELINE && defined(__GLIBC__)
+    cookie_io_functions_t functions = { reader_read, NULL, NULL, reader_close };
+    return pipe_open(file, 0, functions, reader_thread, uring_reader_thread);
+#else
+    return file;
+#endif
+}
+
+FILE *pipe_open_writer(FILE *file){
+#if LZ_PIPELINE && defined(__GLIBC__)
+    cookie_io_functions_t functions = { NULL, writer_write, NULL, writer_close };
+    return pipe_open(file, 1, functions, writer_thread, uring_writer_thread);
+#else
+    return file;
+#endif
+}
+
+/***********************************************************************************************************************
+ * size_t pipe_limit_memory(size_t)
+ *
+ * Limite di memoria degli stream aperti dopo la chiamata (le pipeline di lettura e di scrittura insieme): i pezzi
+ * diventano più piccoli per stare in budget byte, arrotondati a PIPE_CHUNK_ALIGN byte e al massimo PIPE_CHUNK_SIZE.
+ * Con pezzi più piccoli di PIPE_MIN_CHUNK_SIZE la pipeline non vale la sua memoria e viene disattivata: gli stream
+ * aperti sono i file stessi.
+ *
+ * @param budget
+ * @return          --> memoria usata dai pezzi dei due stream, 0 se la pipeline è disattivata
+ */
+size_t pipe_limit_memory(size_t budget){
+#if LZ_PIPELINE && defined(__GLIBC__)
+    chunk_size = budget / (2 * PIPE_CHUNKS) / PIPE_CHUNK_ALIGN * PIPE_CHUNK_ALIGN;
+    if(chunk_size > PIPE_CHUNK_SIZE)
+        chunk_size = PIPE_CHUNK_SIZE;
+    if(chunk_size < PIPE_MIN_CHUNK_SIZE)
+        chunk_size = 0;
+    return 2 * PIPE_CHUNKS * chunk_size;
+#else
+    (void) budget;
+    return 0;
+#endif
+}
+
+/***********************************************************************************************************************
+ * int pipe_close(FILE *, FILE *)
+ *
+ * Chiusura dello stream aperto da pipe_open_reader o pipe_open_writer: aspetta la fine del thread della pipeline (per
+ * la scrittura dopo che tutti i byte sono stati passati al file). Il file resta aperto.
+ *
+ * @param stream
+ * @param file      --> file passato all'apertura dello stream
+ * @return          --> 0, EOF se c'è stato un errore di lettura o di scrittura
+ */
+int pipe_close(FILE *stream, FILE *file){
+    if(stream == file)
+        return ferror(file) ? EOF : 0;
+    return fclose(stream);
+}
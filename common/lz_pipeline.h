@@ -0,0 +1,56 @@
+/***********************************************************************************************************************
+ *
+ *  lz_pipeline.h
+ *
+ *  Lettura e scrittura dei file su thread separati dal codec, condivise da LZ77, LZ78 e LZ.
+ *
+ ***********************************************************************************************************************
+ *
+ *  Senza pipeline lo stesso thread legge il file, comprime (o decomprime) e scrive il risultato, quindi mentre il
+ *  disco legge o scrive il codec è fermo e viceversa. Con la pipeline il lavoro è diviso in tre fasi:
+ *
+ *      thread lettore  --pezzi pieni-->  codec (thread chiamante)  --pezzi pieni-->  thread scrittore
+ *                      <--pezzi vuoti--                            <--pezzi vuoti--
+ *
+ *  Ogni direzione usa PIPE_CHUNKS pezzi di PIPE_CHUNK_SIZE byte (triplo buffer): il lettore riempie i pezzi in
+ *  anticipo mentre il codec consuma quello corrente, lo scrittore scrive i pezzi completati mentre il codec riempie il
+ *  successivo. I pezzi passano da un thread all'altro tramite code circolari limitate senza lock (un solo produttore e
+ *  un solo consumatore); un thread che trova la coda vuota cede il processore e poi attende con brevi pause.
+ *
+ *  pipe_open_reader e pipe_open_writer restituiscono uno stream (FILE *) al posto del file, quindi il codec legge e
+ *  scrive con le solite funzioni di stdio senza sapere della pipeline. Lo stream va chiuso con pipe_close prima di
+ *  usare di nuovo il file (posizione, grandezza, chiusura); gli errori di scrittura del thread scrittore vengono
+ *  riportati da pipe_close.
+ *
+ *  Per i file regolari il thread lettore e il thread scrittore usano io_uring quando il kernel lo permette (vedi
+ *  lz_uring.h): tutti i pezzi liberi sono in lettura o in scrittura contemporaneamente, con i pezzi registrati come
+ *  buffer del kernel. Altrimenti i thread usano fread e fwrite, un pezzo alla volta.
+ *
+ *  Con un limite di memoria (vedi pipe_limit_memory) i pezzi diventano più piccoli, fino a disattivare la pipeline.
+ *
+ *  Se la pipeline non è disponibile (compilando con -DLZ_PIPELINE=0, senza glibc, memoria insufficiente, limite di
+ *  memoria troppo piccolo o thread non creato) lo stream restituito è il file stesso e la lettura e la scrittura
+ *  avvengono sul thread del codec.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_PIPELINE_H
+#define LZ_PIPELINE_H
+
+#include <stdio.h>
+
+#ifndef LZ_PIPELINE
+#define LZ_PIPELINE 1
+#endif
+
+#define PIPE_CHUNK_SIZE 1048576     //byte di ogni pezzo (1 MB)
+#define PIPE_CHUNKS 3               //pezzi di ogni stream (triplo buffer)
+#define PIPE_MIN_CHUNK_SIZE 16384   //pezzi più piccoli con il limite di memoria disattivano la pipeline
+#define PIPE_CHUNK_ALIGN 4096       //arrotondamento dei pezzi con il limite di memoria
+
+size_t pipe_limit_memory(size_t budget);
+FILE *pipe_open_reader(FILE *file);
+FILE *pipe_open_writer(FILE *file);
+int pipe_close(FILE *stream, FILE *file);
+
+#endif
@@ -0,0 +1,64 @@
+/***********************************************************************************************************************
+ *
+ *  lz_stats.c
+ *
+ *  Funzioni di supporto per l'esportazione JSON delle statistiche (vedi lz_stats.h).
+ *
+ **********************************************************************************************************************/
+
+#include <stdlib.h>
+#include "lz_stats.h"
+
+/***********************************************************************************************************************
+ * int stats_log2_bucket(unsigned long long)
+ *
+ * @return  0 se n = 0, altrimenti il numero di bit necessari per rappresentare n (1 -> 1, 2..3 -> 2, 4..7 -> 3, ...)
+ */
+int stats_log2_bucket(unsigned long long n){
+    int bucket = 0;
+    while(n != 0 && bucket < STATS_LOG2_BUCKETS-1){
+        n >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/***********************************************************************************************************************
+ * FILE *stats_open(void)
+ * void stats_close(FILE *)
+ *
+ * Apertura del file indicato da LZ_STATS_JSON (in aggiunta) o, in sua assenza, dello standard output.
+ */
+FILE *stats_open(void){
+    const char *path = getenv("LZ_STATS_JSON");
+    FILE *out;
+
+    if(path == NULL || *path == '\0')
+        return stdout;
+    if((out = fopen(path, "a")) == NULL){
+        printf("!WARNING! Cannot open stats file (%s)\n", path);
+        return stdout;
+    }
+    return out;
+}
+
+void stats_close(FILE *out){
+    if(out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+}
+
+/***********************************************************************************************************************
+ * void stats_json_histogram(FILE *, const char *, const unsigned long long [], int)
+ *
+ * Scrive un istogramma come campo JSON ("name":[h0,h1,...]) senza gli ultimi bucket vuoti.
+ */
+void stats_json_histogram(FILE *out, const char *name, const unsigned long long hist[], int size){
+    while(size > 1 && hist[size-1] == 0)
+        size--;
+    fprintf(out, "\"%s\":[", name);
+    for(int i=0; i<size; i++)
+        fprintf(out, "%s%llu", i ? "," : "", hist[i]);
+    fprintf(out, "]");
+}
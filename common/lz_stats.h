@@ -0,0 +1,47 @@
+/***********************************************************************************************************************
+ *
+ *  lz_stats.h
+ *
+ *  Statistiche sulle sequenze trovate, condivise da LZ77 e LZ78.
+ *
+ ***********************************************************************************************************************
+ *
+ *  Compilando con -DLZ_STATS=1 i due algoritmi contano le codifiche generate (lunghezze, offset, letterali, numero di
+ *  confronti fatti durante la ricerca, ...) e alla fine dell'esecuzione le scrivono in formato JSON.
+ *  Il JSON viene scritto nel file indicato dalla variabile d'ambiente LZ_STATS_JSON oppure, se non è impostata,
+ *  sullo standard output.
+ *
+ *  Con LZ_STATS=0 (default) le macro STATS_* non generano codice, quindi la versione normale non paga nulla.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_STATS_H
+#define LZ_STATS_H
+
+#include <stdio.h>
+
+#ifndef LZ_STATS
+#define LZ_STATS 0
+#endif
+
+#define STATS_LOG2_BUCKETS 33       //istogrammi logaritmici: bucket i = valori in [2^(i-1), 2^i), bucket 0 = valore 0
+
+#if LZ_STATS
+#define STATS_INC(field)            ((field)++)
+#define STATS_ADD(field, n)         ((field) += (n))
+#define STATS_HIST(hist, i, max)    ((hist)[(i) < (max) ? (i) : (max)-1]++)
+#define STATS_LOG2(hist, n)         ((hist)[stats_log2_bucket(n)]++)
+#else
+#define STATS_INC(field)            ((void) 0)
+#define STATS_ADD(field, n)         ((void) 0)
+#define STATS_HIST(hist, i, max)    ((void) 0)
+#define STATS_LOG2(hist, n)         ((void) 0)
+#endif
+
+int stats_log2_bucket(unsigned long long n);
+
+FILE *stats_open(void);
+void stats_close(FILE *out);
+void stats_json_histogram(FILE *out, const char *name, const unsigned long long hist[], int size);
+
+#endif
@@ -0,0 +1,300 @@
+/***********************************************************************************************************************
+ *
+ *  lz_timing.c
+ *
+ *  Implementazione della misurazione dei tempi per fase (vedi lz_timing.h).
+ *
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lz_timing.h"
+
+#if PHASE_PERF && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_AVAILABLE 1
+#else
+#define PERF_AVAILABLE 0
+#endif
+
+static const char *phase_names[N_PHASES] = {
+    "other", "read", "search", "encode", "pack", "unpack", "copy", "write"
+};
+
+static const char *counter_names[N_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+//le fasi sono misurate separatamente per ogni thread, viene riportato solo il thread che chiama timing_report
+static LZ_THREAD_LOCAL unsigned long long phase_elapsed[N_PHASES];     //tempo esclusivo di ogni fase [ns]
+static LZ_THREAD_LOCAL unsigned long long phase_calls[N_PHASES];       //numero di ingressi in ogni fase
+static LZ_THREAD_LOCAL enum lz_phase phase_stack[PHASE_STACK_SIZE];    //fasi annidate attualmente attive
+static LZ_THREAD_LOCAL int phase_depth = 0;
+static LZ_THREAD_LOCAL unsigned long long phase_last = 0;              //istante dell'ultimo cambio di fase
+static unsigned long long time_begin = 0;
+static unsigned long long time_end = 0;
+
+static LZ_THREAD_LOCAL unsigned long long phase_counters[N_PHASES][N_COUNTERS];    //contatori hardware esclusivi di ogni fase
+static LZ_THREAD_LOCAL unsigned long long counters_last[N_COUNTERS];               //valori letti all'ultimo cambio di fase
+static int counters_enabled = 0;
+
+unsigned long long time_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + (unsigned long long) ts.tv_nsec;
+}
+
+/***********************************************************************************************************************
+                                              CONTATORI HARDWARE
+***********************************************************************************************************************/
+
+#if PERF_AVAILABLE
+
+static int counter_fd[N_COUNTERS];      //descrittori dei contatori (-1 se il contatore non è disponibile)
+static int counter_slot[N_COUNTERS];    //posizione del contatore nella lettura di gruppo
+static int counter_group = -1;          //descrittore del leader del gruppo (cicli)
+static int counter_opened = 0;          //contatori aperti nel gruppo
+
+static int perf_open(unsigned int type, unsigned long long config, int group){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group == -1;        //il leader parte disabilitato, i membri seguono il leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/*
+ * Apertura del gruppo di contatori. Il primo contatore (cicli) è il leader: se non può essere aperto i contatori
+ * vengono disabilitati, mentre gli altri contatori non supportati vengono semplicemente saltati.
+ */
+static void counters_open(void){
+    static const unsigned int types[N_COUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    static const unsigned long long configs[N_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    if(counter_group != -1)
+        return;
+
+    counter_opened = 0;
+    for(int i=0; i<N_COUNTERS; i++){
+        counter_fd[i] = perf_open(types[i], configs[i], counter_group);
+        counter_slot[i] = -1;
+        if(counter_fd[i] == -1){
+            if(i == 0){
+                printf("!WARNING! Hardware counters not available (perf_event_open), measuring time only.\n");
+                return;
+            }
+            continue;
+        }
+        if(i == 0)
+            counter_group = counter_fd[i];
+        counter_slot[i] = counter_opened++;
+    }
+
+    ioctl(counter_group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counter_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    counters_enabled = 1;
+}
+
+/*
+ * Lettura di tutti i contatori del gruppo con una sola chiamata read: { nr, valore[0], ..., valore[nr-1] }
+ */
+static void counters_read(unsigned long long values[]){
+    unsigned long long group[1 + N_COUNTERS];
+    if(read(counter_group, group, sizeof(group)) <= 0)
+        return;
+    for(int i=0; i<N_COUNTERS; i++)
+        values[i] = counter_slot[i] == -1 ? 0 : group[1 + counter_slot[i]];
+}
+
+#else
+
+static void counters_open(void){
+}
+
+static void counters_read(unsigned long long values[]){
+    (void) values;
+}
+
+#endif
+
+/***********************************************************************************************************************
+ * static void phase_switch(void)
+ *
+ * Attribuisce il tempo (e i contatori) trascorsi dall'ultimo cambio di fase alla fase in cima allo stack.
+ */
+static void phase_switch(void){
+    unsigned long long now = time_now_ns();
+    enum lz_phase current = phase_stack[phase_depth];
+
+    if(counters_enabled){
+        unsigned long long values[N_COUNTERS];
+        counters_read(values);
+        for(int i=0; i<N_COUNTERS; i++){
+            phase_counters[current][i] += values[i] - counters_last[i];
+            counters_last[i] = values[i];
+        }
+    }
+
+    phase_elapsed[current] += now - phase_last;
+    phase_last = now;
+}
+
+/***********************************************************************************************************************
+ * void timing_start(void)
+ *
+ * Azzera tutti i contatori e fa partire la misurazione. La fase attiva all'inizio è PHASE_OTHER.
+ */
+void timing_start(void){
+    for(int i=0; i<N_PHASES; i++){
+        phase_elapsed[i]=0;
+        phase_calls[i]=0;
+        for(int j=0; j<N_COUNTERS; j++)
+            phase_counters[i][j]=0;
+    }
+    phase_depth=0;
+    phase_stack[0]=PHASE_OTHER;
+
+    if(PHASE_PERF){
+        counters_open();
+        if(counters_enabled)
+            counters_read(counters_last);
+    }
+
+    time_begin = time_now_ns();
+    time_end = time_begin;
+    phase_last = time_begin;
+}
+
+void timing_stop(void){
+    phase_switch();
+    time_end = phase_last;
+}
+
+double timing_seconds(void){
+    return (double) (time_end - time_begin) / 1e9;
+}
+
+/***********************************************************************************************************************
+ * void phase_push(enum lz_phase)
+ * void phase_pop(void)
+ *
+ * Il tempo trascorso dall'ultimo cambio di fase viene attribuito alla fase in cima allo stack, poi la nuova fase
+ * viene inserita (push) o quella corrente viene tolta (pop).
+ */
+void phase_push(enum lz_phase phase){
+    phase_switch();
+    if(phase_depth < PHASE_STACK_SIZE-1)
+        phase_depth++;
+    phase_stack[phase_depth] = phase;
+    phase_calls[phase]++;
+}
+
+void phase_pop(void){
+    phase_switch();
+    if(phase_depth > 0)
+        phase_depth--;
+}
+
+/***********************************************************************************************************************
+ * void timing_report(FILE *)
+ *
+ * Stampa il tempo totale e, se sono state misurate delle fasi, la suddivisione per fase (con i contatori hardware se
+ * disponibili).
+ */
+void timing_report(FILE *out){
+    unsigned long long total = time_end - time_begin;
+    int any = 0;
+
+    fprintf(out, "\nExecution Time:  %f [seconds]\n", timing_seconds());
+
+    for(int i=1; i<N_PHASES; i++)
+        if(phase_calls[i] != 0)
+            any = 1;
+    if(!any)
+        return;
+
+    fprintf(out, "\n%-8s %16s %10s %16s\n", "phase", "time [ns]", "share", "calls");
+    for(int i=0; i<N_PHASES; i++){
+        if(phase_elapsed[i]==0 && phase_calls[i]==0)
+            continue;
+        fprintf(out, "%-8s %16llu %9.2f%% %16llu\n", phase_names[i], phase_elapsed[i],
+                total ? 100.0 * (double) phase_elapsed[i] / (double) total : 0.0, phase_calls[i]);
+    }
+
+    if(!counters_enabled)
+        return;
+
+    fprintf(out, "\n%-8s", "phase");
+    for(int j=0; j<N_COUNTERS; j++)
+        fprintf(out, " %16s", counter_names[j]);
+    fprintf(out, " %8s\n", "IPC");
+    for(int i=0; i<N_PHASES; i++){
+        if(phase_elapsed[i]==0 && phase_calls[i]==0)
+            continue;
+        fprintf(out, "%-8s", phase_names[i]);
+        for(int j=0; j<N_COUNTERS; j++)
+            fprintf(out, " %16llu", phase_counters[i][j]);
+        fprintf(out, " %8.2f\n", phase_counters[i][COUNTER_CYCLES] ?
+                (double) phase_counters[i][COUNTER_INSTRUCTIONS] / (double) phase_counters[i][COUNTER_CYCLES] : 0.0);
+    }
+}
+
+/***********************************************************************************************************************
+ * void timing_export(const char *, const char *)
+ *
+ * Se la variabile d'ambiente LZ_TIMING_JSON è impostata aggiunge al file indicato una riga JSON del tipo:
+ *
+ * {"codec":"lz77","mode":"compress","total_ns":123,"phases":{"other":1,"read":2,...}}
+ *
+ * Con i contatori hardware attivi viene aggiunto il campo "counters":{"other":{"cycles":1,...},...}
+ */
+void timing_export(const char *codec, const char *mode){
+    const char *path = getenv("LZ_TIMING_JSON");
+    FILE *out;
+
+    if(path == NULL || *path == '\0')
+        return;
+    if((out = fopen(path, "a")) == NULL){
+        printf("!WARNING! Cannot open timing file (%s)\n", path);
+        return;
+    }
+
+    fprintf(out, "{\"codec\":\"%s\",\"mode\":\"%s\",\"total_ns\":%llu,\"phases\":{", codec, mode,
+            time_end - time_begin);
+    for(int i=0; i<N_PHASES; i++)
+        fprintf(out, "%s\"%s\":%llu", i ? "," : "", phase_names[i], phase_elapsed[i]);
+    fprintf(out, "}");
+
+    if(counters_enabled){
+        fprintf(out, ",\"counters\":{");
+        for(int i=0; i<N_PHASES; i++){
+            fprintf(out, "%s\"%s\":{", i ? "," : "", phase_names[i]);
+            for(int j=0; j<N_COUNTERS; j++)
+                fprintf(out, "%s\"%s\":%llu", j ? "," : "", counter_names[j], phase_counters[i][j]);
+            fprintf(out, "}");
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "}\n");
+
+    fclose(out);
+}
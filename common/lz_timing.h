@@ -0,0 +1,99 @@
+/***********************************************************************************************************************
+ *
+ *  lz_timing.h
+ *
+ *  Misurazione dei tempi di esecuzione, condivisa da LZ77 e LZ78.
+ *
+ ***********************************************************************************************************************
+ *
+ *  Il tempo totale viene misurato con un orologio monotono (CLOCK_MONOTONIC) con risoluzione al nanosecondo, quindi
+ *  si tratta di tempo reale e non di tempo CPU come con clock().
+ *
+ *  Compilando con -DPHASE_TIMING=1 il tempo viene inoltre suddiviso per fase (lettura input, ricerca, codifica,
+ *  scrittura bufferizzata, ...). Le fasi sono annidate: PHASE_PUSH entra in una fase e PHASE_POP torna a quella
+ *  precedente, ogni intervallo di tempo viene attribuito solo alla fase più interna attiva in quel momento.
+ *  In questo modo la somma delle fasi corrisponde al tempo totale.
+ *
+ *  Con PHASE_TIMING=0 (default) le macro non generano codice e il costo è nullo.
+ *
+ *  Compilando con -DPHASE_PERF=1 (solo Linux, implica PHASE_TIMING=1) ad ogni cambio di fase vengono letti anche i
+ *  contatori hardware della CPU tramite perf_event_open: cicli, istruzioni, miss della cache L1 dati e dell'ultimo
+ *  livello di cache (LLC), branch mispredette. In questo modo si può capire se una fase è limitata dagli accessi in
+ *  memoria o dalle predizioni dei salti. Se il kernel non permette l'apertura dei contatori (vedi
+ *  /proc/sys/kernel/perf_event_paranoid) viene stampato un avviso e si misurano solo i tempi.
+ *
+ *  Se la variabile d'ambiente LZ_TIMING_JSON contiene il percorso di un file, alla fine dell'esecuzione viene aggiunta
+ *  a quel file una riga JSON con i tempi misurati.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_TIMING_H
+#define LZ_TIMING_H
+
+#include <stdio.h>
+
+#ifndef PHASE_PERF
+#define PHASE_PERF 0
+#endif
+
+#if PHASE_PERF
+#undef PHASE_TIMING
+#define PHASE_TIMING 1
+#endif
+
+#ifndef PHASE_TIMING
+#define PHASE_TIMING 0
+#endif
+
+#define PHASE_STACK_SIZE 16
+
+// variabili globali con una copia per ogni thread (compressione a blocchi su più thread)
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define LZ_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define LZ_THREAD_LOCAL __thread
+#else
+#define LZ_THREAD_LOCAL
+#endif
+
+enum lz_phase {
+    PHASE_OTHER,        //tutto ciò che non rientra in una fase specifica
+    PHASE_READ,         //lettura del file di input
+    PHASE_SEARCH,       //ricerca delle sequenze (finestra / dizionario)
+    PHASE_ENCODE,       //costruzione delle codifiche
+    PHASE_PACK,         //scrittura bufferizzata (conversione in bit)
+    PHASE_UNPACK,       //lettura bufferizzata (estrazione dei bit)
+    PHASE_COPY,         //ricostruzione dei byte decompressi
+    PHASE_WRITE,        //scrittura del file di output
+    N_PHASES
+};
+
+enum lz_counter {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    N_COUNTERS
+};
+
+unsigned long long time_now_ns(void);
+
+void timing_start(void);
+void timing_stop(void);
+double timing_seconds(void);
+void timing_report(FILE *out);
+void timing_export(const char *codec, const char *mode);
+
+void phase_push(enum lz_phase phase);
+void phase_pop(void);
+
+#if PHASE_TIMING
+#define PHASE_PUSH(p)   phase_push(p)
+#define PHASE_POP()     phase_pop()
+#else
+#define PHASE_PUSH(p)   ((void) 0)
+#define PHASE_POP()     ((void) 0)
+#endif
+
+#endif
@@ -0,0 +1,242 @@
+/***********************************************************************************************************************
+ *
+ *  lz_uring.c
+ *
+ *  Implementazione dell'anello io_uring usato dalla pipeline (vedi lz_uring.h).
+ *
+ ***********************************************************************************************************************
+ *
+ *  L'anello è formato da due code condivise con il kernel:
+ *
+ *  SQ (submission queue)   richieste scritte dal thread: il thread riempie una voce (sqe), ne mette la posizione in
+ *                          sq_array e avanza sq_tail; il kernel avanza sq_head quando ha preso le richieste
+ *  CQ (completion queue)   risultati scritti dal kernel: il kernel riempie una voce (cqe) e avanza cq_tail, il thread
+ *                          legge il risultato e avanza cq_head
+ *
+ *  Ogni anello è usato da un solo thread, quindi gli unici accessi concorrenti sono quelli con il kernel agli indici
+ *  delle code (letture acquire e scritture release).
+ *
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE                 //syscall
+
+#include <stdlib.h>
+#include "lz_uring.h"
+
+#if LZ_IO_URING && defined(__linux__)
+#include <errno.h>
+#include <string.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if LZ_IO_URING && defined(__linux__) && defined(__NR_io_uring_setup)
+
+struct _uring{
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;        //memoria delle code condivisa con il kernel (cq_ring = sq_ring con una sola mmap)
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned char *buffers[URING_ENTRIES];     //buffer registrati
+    unsigned pending;               //richieste scritte ma non ancora inviate al kernel
+};
+
+/***********************************************************************************************************************
+ * void uring_destroy(Uring *)
+ *
+ * Chiusura dell'anello (i buffer registrati vengono rilasciati dal kernel con la chiusura del descrittore).
+ */
+void uring_destroy(Uring *ring){
+    if(ring == NULL)
+        return;
+    if(ring->sqes != NULL && ring->sqes != MAP_FAILED)
+        munmap(ring->sqes, ring->sqes_size);
+    if(ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring)
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    if(ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED)
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    if(ring->fd >= 0)
+        close(ring->fd);
+    free(ring);
+}
+
+/***********************************************************************************************************************
+ * Uring *uring_create(unsigned char *[], int, size_t)
+ *
+ * Creazione di un anello di URING_ENTRIES richieste e registrazione degli n buffer di size byte.
+ *
+ * @param buffers
+ * @param n         --> buffer (al massimo URING_ENTRIES)
+ * @param size      --> byte di ogni buffer
+ * @return          --> anello, NULL se io_uring non è disponibile
+ */
+Uring *uring_create(unsigned char *buffers[], int n, size_t size){
+    struct io_uring_params params;
+    struct iovec iov[URING_ENTRIES];
+    Uring *ring = calloc(1, sizeof(Uring));
+
+    if(ring == NULL)
+        return NULL;
+    ring->fd = -1;
+    if(n > URING_ENTRIES)
+        goto fail;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int) syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if(ring->fd < 0)
+        goto fail;
+
+    //mappatura delle code (con IORING_FEAT_SINGLE_MMAP le due code stanno nella stessa memoria)
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP){
+        if(ring->cq_ring_size > ring->sq_ring_size)
+            ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    if(ring->sq_ring == MAP_FAILED)
+        goto fail;
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_ring = ring->sq_ring;
+    else
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                             IORING_OFF_CQ_RING);
+    if(ring->cq_ring == MAP_FAILED)
+        goto fail;
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if(ring->sqes == MAP_FAILED)
+        goto fail;
+
+    ring->sq_head = (unsigned *) ((char *) ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (unsigned *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+
+    //registrazione dei buffer (può essere rifiutata per il limite di memoria bloccata, RLIMIT_MEMLOCK)
+    for(int i=0; i<n; i++){
+        iov[i].iov_base = ring->buffers[i] = buffers[i];
+        iov[i].iov_len = size;
+    }
+    if(syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, iov, n) < 0)
+        goto fail;
+    return ring;
+
+fail:
+    uring_destroy(ring);
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * void uring_prepare(Uring *, int, int, int, size_t, size_t, long long)
+ * void uring_read(Uring *, int, int, size_t, size_t, long long)
+ * void uring_write(Uring *, int, int, size_t, size_t, long long)
+ *
+ * Richiesta di lettura o di scrittura di length byte del file fd alla posizione offset, dal byte start del buffer
+ * registrato buffer. La richiesta viene inviata al kernel dalla prossima uring_wait insieme alle altre, il risultato
+ * viene riportato da uring_wait con l'indice del buffer.
+ * Ogni buffer può avere al massimo una richiesta in corso, quindi la coda di invio non è mai piena.
+ */
+static void uring_prepare(Uring *ring, int opcode, int fd, int buffer, size_t start, size_t length, long long offset){
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (unsigned char) opcode;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long long) (unsigned long) (ring->buffers[buffer] + start);
+    sqe->len = (unsigned) length;
+    sqe->off = (unsigned long long) offset;
+    sqe->buf_index = (unsigned short) buffer;
+    sqe->user_data = (unsigned long long) buffer;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+}
+
+void uring_read(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset){
+    uring_prepare(ring, IORING_OP_READ_FIXED, fd, buffer, start, length, offset);
+}
+
+void uring_write(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset){
+    uring_prepare(ring, IORING_OP_WRITE_FIXED, fd, buffer, start, length, offset);
+}
+
+/***********************************************************************************************************************
+ * int uring_wait(Uring *, int *, int *)
+ *
+ * Invio al kernel delle richieste in attesa e attesa del prossimo risultato. Se un risultato è già disponibile
+ * io_uring_enter invia le richieste senza aspettare.
+ *
+ * @param ring
+ * @param buffer    --> indice del buffer della richiesta completata
+ * @param result    --> byte letti o scritti, -errno in caso di errore
+ * @return          --> 1, 0 se il kernel ha rifiutato la chiamata (le richieste in corso sono perse)
+ */
+int uring_wait(Uring *ring, int *buffer, int *result){
+    unsigned head;
+    int submitted;
+
+    for(;;){
+        head = *ring->cq_head;
+        if(ring->pending == 0 && head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)){
+            *buffer = (int) ring->cqes[head & *ring->cq_mask].user_data;
+            *result = ring->cqes[head & *ring->cq_mask].res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+            return 1;
+        }
+        submitted = (int) syscall(__NR_io_uring_enter, ring->fd, ring->pending, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if(submitted < 0 && errno != EINTR)
+            return 0;
+        if(submitted > 0)
+            ring->pending -= (unsigned) submitted;
+    }
+}
+
+#else
+
+Uring *uring_create(unsigned char *buffers[], int n, size_t size){
+    (void) buffers;
+    (void) n;
+    (void) size;
+    return NULL;
+}
+
+void uring_destroy(Uring *ring){
+    (void) ring;
+}
+
+void uring_read(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset){
+    (void) ring;
+    (void) fd;
+    (void) buffer;
+    (void) start;
+    (void) length;
+    (void) offset;
+}
+
+void uring_write(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset){
+    uring_read(ring, fd, buffer, start, length, offset);
+}
+
+int uring_wait(Uring *ring, int *buffer, int *result){
+    (void) ring;
+    (void) buffer;
+    (void) result;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+/***********************************************************************************************************************
+ *
+ *  lz_uring.h
+ *
+ *  Lettura e scrittura dei file con io_uring (solo Linux), usate dai thread della pipeline (vedi lz_pipeline.h).
+ *
+ ***********************************************************************************************************************
+ *
+ *  Con fread e fwrite ogni pezzo costa almeno una chiamata di sistema e il thread aspetta la fine di ogni lettura prima
+ *  di chiedere la successiva. Con io_uring il thread mette le richieste in una coda condivisa con il kernel e le
+ *  invia tutte insieme con una sola chiamata (io_uring_enter), quindi tutti i pezzi liberi della pipeline sono in
+ *  lettura o in scrittura contemporaneamente e il disco ha sempre più richieste da servire.
+ *
+ *  I pezzi della pipeline sono registrati nel kernel (IORING_REGISTER_BUFFERS) una volta sola alla creazione
+ *  dell'anello, le richieste usano quindi IORING_OP_READ_FIXED e IORING_OP_WRITE_FIXED, che non devono mappare le
+ *  pagine del buffer ad ogni operazione.
+ *
+ *  L'anello viene chiesto direttamente al kernel con le chiamate di sistema (senza liburing). uring_create restituisce
+ *  NULL se io_uring non è disponibile (compilando con -DLZ_IO_URING=0, kernel senza io_uring o con io_uring
+ *  disabilitato, registrazione dei buffer rifiutata): in quel caso la pipeline usa fread e fwrite.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LZ_URING_H
+#define LZ_URING_H
+
+#include <stddef.h>
+
+#ifndef LZ_IO_URING
+#define LZ_IO_URING 1
+#endif
+
+#define URING_ENTRIES 8             //richieste nella coda di invio (almeno i pezzi di uno stream)
+
+typedef struct _uring Uring;
+
+Uring *uring_create(unsigned char *buffers[], int n, size_t size);
+void uring_destroy(Uring *ring);
+void uring_read(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset);
+void uring_write(Uring *ring, int fd, int buffer, size_t start, size_t length, long long offset);
+int uring_wait(Uring *ring, int *buffer, int *result);
+
+#endif